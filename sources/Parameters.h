@@ -23,15 +23,46 @@
 
 namespace param {
     const int LevelSize = 3;
+    // niveau long (en ecrans), construit au fur et a mesure par morceaux d'un ecran
+    const int LongLevelSize = 30;
+    const int CoinsPerChunk = 7;
 
     const float CoinScale = 0.6;
 
 	//nombre d'aller-retour (defaut = 10)
 	const int runner = 10;
 
+	// mode sans fin : runners crees d'avance (les suivants sont crees a la demande)
+	const int EndlessPreallocatedRunners = 128;
+
 	//vitesse de base (defaut = 0.7)
 	const float speedConst = COMPUTE_SPEED_FROM_GAME_DURATION(90.5); //6.9; //0.8;
 
 	//vitesse proportionnel au nombre de ghost (defaut = 0)
 	const float speedCoeff = 0; // 0.08;
+
+	// saut : impulsion initiale, puis poussee tant que le doigt est appuye
+	const float MinJumpDuration = 0.005;
+	const float MaxJumpDuration = 0.2;
+	const float JumpImpulse = 1800 * 1.5;
+	const float JumpHoldForce = 100;
+	const float JumpHoldGravity = -50;
+	const float FallGravity = -150;
+
+	// zones de collision ajustees aux sprites (assets/runner.collision) au lieu de celles
+	// faites a la main : pas encore testees en jeu
+	const bool FittedCollisionZones = false;
+
+	// un ghost ne peut tuer qu'apres ce delai (secondes)
+	const float GhostKillDelay = 0.25;
+
+	// niveau 3 : nombre de plateformes (chacune a 2 interrupteurs), reparties sur plusieurs rangees
+	const int PlatformCount = 200;
+	const int PlatformRows = 5;
+
+	// replays : nombre de segments (un par lancement du jeu) gardes
+	const int ReplaySegmentsKept = 20;
+
+	// frequence de la simulation (Hz), l'affichage interpole entre 2 pas (0 = un pas par image)
+	const int SimulationTickRate = 120;
 }
@@ -22,6 +22,7 @@
 #include "Parameters.h"
 
 #include <sstream>
+#include <memory>
 
 #include "base/Log.h"
 #include "base/TouchInputManager.h"
@@ -51,14 +52,24 @@
 #include "systems/SessionSystem.h"
 #include "systems/PlatformerSystem.h"
 
+#include "api/AssetAPI.h"
 #include "api/LocalizeAPI.h"
 #include "api/StorageAPI.h"
 #include "api/InAppPurchaseAPI.h"
 #include "util/ScoreStorageProxy.h"
 #include "util/StatsStorageProxy.h"
+#include "util/ScoreHistory.h"
 
 #include "util/RecursiveRunnerDebugConsole.h"
 #include "util/Random.h"
+#include "util/DecorLayout.h"
+
+#include "simulation/Replay.h"
+#include "simulation/RunnerRules.h"
+#include "simulation/StatsLog.h"
+#if SAC_BENCHMARK_MODE
+#include "simulation/SimulationBenchmark.h"
+#endif
 
 #include <glm/gtc/random.hpp>
 #include <glm/gtx/vector_angle.hpp>
@@ -77,20 +88,22 @@
 #include "systems/SpotSystem.h"
 #include "systems/SwypeButtonSystem.h"
 
-extern std::map<TextureRef, CollisionZone> texture2Collision;
-
-float RecursiveRunnerGame::nextRunnerStartTime[100];
-int RecursiveRunnerGame::nextRunnerStartTimeIndex;
 
 RecursiveRunnerGame::RecursiveRunnerGame(): Game() {
     LOGI(sizeof(Game));
     statistics.allTimeBest = 0;
     statistics.sessionBest = 0;
     statistics.lastGame = 0;
+    collisionTable = 0;
+    gameCount = 0;
 }
 
 
 RecursiveRunnerGame::~RecursiveRunnerGame() {
+    // pending writes are done before leaving
+    flushPersistence();
+    persistence.stop();
+    delete[] collisionTable;
     RunnerSystem::DestroyInstance();
     CameraTargetSystem::DestroyInstance();
     PlayerSystem::DestroyInstance();
@@ -222,172 +235,49 @@ void RecursiveRunnerGame::decor() {
     Entity trees = theEntityManager.CreateEntity(HASH("trees", 0xe84e02fd),
         EntityType::Persistent, theEntityManager.entityTemplateLibrary.load("background/city-object"));
 
-    int count = 33;
-    struct Decor {
-        float x, y, z;
-        Cardinal::Enum ref;
-        const char* texture;
-        bool mirrorUV;
-        Entity parent;
-        Decor(float _x=0, float _y=0, float _z=0, Cardinal::Enum _ref=Cardinal::C, const char* _texture="", bool _mirrorUV=false, Entity _parent=0) :
-            x(_x), y(_y), z(_z), ref(_ref), texture(_texture), mirrorUV(_mirrorUV), parent(_parent) {}
-    };
-
-    Decor def[] = {
-        // buildings
-        Decor(554, 149, 0.2, Cardinal::NE, "immeuble", false, buildings),
-        Decor(1690, 149, 0.2, Cardinal::NE, "immeuble", false, buildings),
-        Decor(3173, 139, 0.2, Cardinal::NW, "immeuble", false, buildings),
-        Decor(358, 404, 0.25, Cardinal::NW, "maison", true, buildings),
-        Decor(2097, 400, 0.25, Cardinal::NE, "maison", false, buildings),
-        Decor(2053, 244, 0.29, Cardinal::NW, "usine_desaf", false, buildings),
-        Decor(3185, 298, 0.22, Cardinal::NE, "usine2", true, buildings),
-        // trees
-        Decor(152, 780, 0.5, Cardinal::S, "arbre3", false, trees),
-        Decor(522, 780, 0.5, Cardinal::S, "arbre2", false, trees),
-        Decor(812, 774, 0.45, Cardinal::S, "arbre5", false, trees),
-        Decor(1162, 792, 0.5, Cardinal::S, "arbre4", false, trees),
-        Decor(1418, 790, 0.45, Cardinal::S, "arbre2", false, trees),
-        Decor(1600, 768, 0.42, Cardinal::S, "arbre1", false, trees),
-        Decor(1958, 782, 0.5, Cardinal::S, "arbre4", true, trees),
-        Decor(2396, 774, 0.44, Cardinal::S, "arbre5", false, trees),
-        Decor(2684, 784, 0.45, Cardinal::S, "arbre3", false, trees),
-        Decor(3022, 764, 0.42, Cardinal::S, "arbre1", false, trees),
-        Decor(3290, 764, 0.41, Cardinal::S, "arbre1", true, trees),
-        Decor(3538, 768, 0.44, Cardinal::S, "arbre2", false, trees),
-        Decor(3820, 772, 0.5, Cardinal::S, "arbre4", false, trees),
-        // benchs
-        Decor(672, 768, 0.35, Cardinal::S, "bench_cat", false, trees),
-        Decor(1090, 764, 0.35, Cardinal::S, "bench", false, trees),
-        Decor(2082, 760, 0.35, Cardinal::S, "bench", true, trees),
-        Decor(2526, 762, 0.35, Cardinal::S, "bench", false, trees),
-        Decor(3464, 758, 0.35, Cardinal::S, "bench_cat", false, trees),
-        Decor(3612, 762, 0.6, Cardinal::S, "bench", false, trees),
-        // lampadaire
-        Decor(472, 748, 0.3, Cardinal::S, "lampadaire2", false, trees),
-        Decor(970, 748, 0.3, Cardinal::S, "lampadaire3", false, trees),
-        Decor(1740, 748, 0.3, Cardinal::S, "lampadaire2", false, trees),
-        Decor(2208, 748, 0.3, Cardinal::S, "lampadaire1", false, trees),
-        Decor(2620, 748, 0.3, Cardinal::S, "lampadaire3", false, trees),
-        Decor(3182, 748, 0.3, Cardinal::S, "lampadaire1", false, trees),
-        Decor(3732, 748, 0.3, Cardinal::S, "lampadaire3", false, trees),
-    };
-    // pour les arbres
-    glm::vec2 v[5][4] = {
-        {glm::vec2(71, 123), glm::vec2(73, 114), glm::vec2(125, 126), glm::vec2(92, 216)},
-        {glm::vec2(116, 153), glm::vec2(78, 155), glm::vec2(100, 168), glm::vec2(44, 46)},
-        {glm::vec2(69, 178), glm::vec2(155, 125), glm::vec2(163, 116), glm::vec2(206, 93)},
-        {glm::vec2(152, 160), glm::vec2(85, 138), glm::vec2(84, 111), glm::vec2(168, 171)},
-        {glm::vec2(115, 67), glm::vec2(146, 69), glm::vec2(132, 107), glm::vec2(124, 130)}
-        };
-    glm::vec2 o[5][4] = {
-        {glm::vec2(0, 0), glm::vec2(313, 0), glm::vec2(0, 498), glm::vec2(293, 624-216)},
-        {glm::vec2(0, 250), glm::vec2(0, 0), glm::vec2(137, 244), glm::vec2(193, 0)},
-        {glm::vec2(0, 0), glm::vec2(308, 0), glm::vec2(300, 510), glm::vec2(0, 499)},
-        {glm::vec2(0, 460), glm::vec2(0, 0), glm::vec2(438, 0), glm::vec2(354, 449)},
-        {glm::vec2(0, 0), glm::vec2(234, 0), glm::vec2(248, 259), glm::vec2(0, 236)}
-        };
-    // pour les batiments
-    glm::vec2 vBat[][4] = {
-        {glm::vec2(901, 44), glm::vec2(215, 35), glm::vec2(174, 41), glm::vec2(265, 37)},
-        {glm::vec2(143, 55), glm::vec2(83, 51), glm::vec2(82, 47), glm::vec2(0.0f)},
-        {glm::vec2(324, 15), glm::vec2(0.0f), glm::vec2(0.0f), glm::vec2(0.0f)},
-        {glm::vec2(124, 233), glm::vec2(630, 69), glm::vec2(245, 71), glm::vec2(0.0f)},
-    };
-    glm::vec2 oBat[][4] = {
-        {glm::vec2(43, 0), glm::vec2(172, 44), glm::vec2(424, 44), glm::vec2(629, 44)},
-        {glm::vec2(12, 0), glm::vec2(169, 0), glm::vec2(344, 0), glm::vec2(0.0f)},
-        {glm::vec2(8, 0), glm::vec2(0.0f), glm::vec2(0.0f), glm::vec2(0.0f)},
-        {glm::vec2(8, 0), glm::vec2(249, 0), glm::vec2(573, 69), glm::vec2(0.0f)},
-
-    };
+    // built by tools/bake_decor.py
+    FileBuffer fb = gameThreadContext->assetAPI->loadAsset("decor.layout");
+    unsigned count;
+    const DecorLayout::Item* items = DecorLayout::items(fb.data, fb.size, count);
+    LOGF_IF(!items, "Invalid or missing decor.layout");
+    const Entity parents[] = { 0, buildings, trees };
 
-    char* fullname = (char*)alloca(256);
-    for (int i=0; i<count; i++) {
-        const Decor& bdef = def[i];
-        strcpy(fullname, "decor/");
-        strcat(fullname, bdef.texture);
+    decorEntities.reserve(decorEntities.size() + count);
+    for (unsigned i=0; i<count; i++) {
+        const DecorLayout::Item& item = items[i];
 
-        Entity b = theEntityManager.CreateEntity(Murmur::RuntimeHash(fullname));
+        Entity b = theEntityManager.CreateEntity(item.name);
+        ADD_COMPONENT(b, Transformation);
         {
-            ADD_COMPONENT(b, Transformation);
-            auto tb = TRANSFORM(b);
-            tb->size = PlacementHelper::GimpSizeToScreen(theRenderingSystem.getTextureSize(bdef.texture));
-            TRANSFORM(b)->position =
-                AnchorSystem::adjustPositionWithCardinal(
-                glm::vec2(PlacementHelper::GimpXToScreen(bdef.x), PlacementHelper::GimpYToScreen(bdef.y)), tb->size, bdef.ref);
-            TRANSFORM(b)->z = bdef.z;
-            ADD_COMPONENT(b, Rendering);
-            RENDERING(b)->texture = theRenderingSystem.loadTextureFile(bdef.texture);
-            RENDERING(b)->show = true;
-            RENDERING(b)->flags = RenderingFlags::NonOpaque;
-            if (bdef.mirrorUV)
-                RENDERING(b)->flags |= RenderingFlags::MirrorHorizontal;
-            if (bdef.parent) {
-                ADD_COMPONENT(b, Anchor);
-                ANCHOR(b)->parent = bdef.parent;
-                ANCHOR(b)->position = TRANSFORM(b)->position;
-                ANCHOR(b)->z = TRANSFORM(b)->z;
-            } else {
-                RENDERING(b)->flags |= RenderingFlags::Constant;
-            }
-
+            TransformationComponent* tb = TRANSFORM(b);
+            tb->size = PlacementHelper::GimpSizeToScreen(glm::vec2(item.width, item.height));
+            tb->position = PlacementHelper::GimpPositionToScreen(glm::vec2(item.x, item.y));
+            tb->z = item.z;
+        }
+        ADD_COMPONENT(b, Rendering);
+        {
+            RenderingComponent* rb = RENDERING(b);
+            rb->texture = theRenderingSystem.loadTextureFile(item.texture);
+            rb->show = true;
+            rb->flags = RenderingFlags::NonOpaque;
+            if (item.flags & DecorLayout::Flag::Mirror)
+                rb->flags |= RenderingFlags::MirrorHorizontal;
+            if (item.parent == DecorLayout::Parent::None)
+                rb->flags |= RenderingFlags::Constant;
+        }
+        if (item.parent != DecorLayout::Parent::None) {
+            ADD_COMPONENT(b, Anchor);
+            ANCHOR(b)->parent = parents[item.parent];
+            ANCHOR(b)->position = TRANSFORM(b)->position;
+            ANCHOR(b)->z = TRANSFORM(b)->z;
         }
         decorEntities.push_back(b);
 
-        if (i < 3) {
+        if (item.flags & DecorLayout::Flag::Smoke) {
             fumee(b);
         }
-        glm::vec2* zPrepassSize = 0, *zPrepassOffset = 0;
-
-        if (strncmp(bdef.texture, "arbre", 5) == 0) {
-            char c = bdef.texture[5];
-            int idx = (int)c - (int)'0' - 1;
-            zPrepassSize = v[idx];
-            zPrepassOffset = o[idx];
-        } else if (!strcmp(bdef.texture, "immeuble")) {
-            zPrepassSize = vBat[0];
-            zPrepassOffset = oBat[0];
-        } else if (!strcmp(bdef.texture, "maison")) {
-            zPrepassSize = vBat[1];
-            zPrepassOffset = oBat[1];
-        } else if (!strcmp(bdef.texture, "usine2")) {
-            zPrepassSize = vBat[2];
-            zPrepassOffset = oBat[2];
-        } else if (!strcmp(bdef.texture, "usine_desaf")) {
-            zPrepassSize = vBat[3];
-            zPrepassOffset = oBat[3];
-        }
-        if (0 && zPrepassSize) {
-            const glm::vec2 size = TRANSFORM(b)->size;
-            #if 0
-            Color color = Color::random();
-            color.a = 0.6;
-            #endif
-            for (int j=0; j<4; j++) {
-                if (zPrepassSize[j] == glm::vec2(0.0f))
-                    break;
-
-                strcpy(fullname, "decor/");
-                strcat(fullname, bdef.texture);
-                strcat(fullname, "_z_pre-pass");
-                Entity bb = theEntityManager.CreateEntity(Murmur::RuntimeHash(fullname));
-                ADD_COMPONENT(bb, Transformation);
-                TRANSFORM(bb)->size = PlacementHelper::GimpSizeToScreen(zPrepassSize[j]);
-                glm::vec2 ratio(zPrepassOffset[j] / theRenderingSystem.getTextureSize(bdef.texture));
-                ratio.y = 1 - ratio.y;
-                glm::vec2 pos =
-                    size * (glm::vec2(-0.5) + ratio)+ TRANSFORM(bb)->size * glm::vec2(0.5, -0.5);
-                if (bdef.mirrorUV)
-                    pos.x = -pos.x;
-                TRANSFORM(bb)->z = TRANSFORM(b)->z;
-                TRANSFORM(bb)->position = TRANSFORM(b)->position + pos;
-                ADD_COMPONENT(bb, Rendering);
-                *RENDERING(bb) = *RENDERING(b);
-                RENDERING(bb)->flags = RenderingFlags::ZPrePass;
-            }
-        }
     }
+    delete[] fb.data;
 
     theEntityManager.CreateEntity(HASH("background/banderolle", 0xa00038cb),
         EntityType::Persistent, theEntityManager.entityTemplateLibrary.load("background/banderolle"));
@@ -477,28 +367,19 @@ void RecursiveRunnerGame::initGame() {
         "12345"
         : ObjectSerializer<int>::object2string(PLAYER(players.front())->points);
 
-    texture2Collision[HASH("jump_l2r_0000", 0x955adbfa)] =  CollisionZone(90,52,28,84,-0.1);
-    texture2Collision[HASH("jump_l2r_0001", 0x2737e4c3)] =  CollisionZone(91,62,27,78,-0.1);
-    texture2Collision[HASH("jump_l2r_0002", 0xcfec26f2)] =  CollisionZone(95,74,23,72, -0.1);
-    texture2Collision[HASH("jump_l2r_0003", 0x11fae020)] =  CollisionZone(95,74,23,70, -0.1);
-    texture2Collision[HASH("jump_l2r_0004", 0x947eb14)] =  CollisionZone(111,95,24,75, -0.3);
-    texture2Collision[HASH("jump_l2r_0005", 0x5a2307d8)] =  CollisionZone(114,94,15,84, -0.5);
-    texture2Collision[HASH("jump_l2r_0006", 0xdf42bc08)] =  CollisionZone(109,100,20,81, -0.5);
-    texture2Collision[HASH("jump_l2r_0007", 0x223d3232)] =  CollisionZone(101, 96,24,85,-0.2);
-    texture2Collision[HASH("jump_l2r_0008", 0x70ba05a2)] =  CollisionZone(100, 98,25,74,-0.15);
-    texture2Collision[HASH("jump_l2r_0009", 0x4d5e5e36)] =  CollisionZone(95,95,25, 76, 0.0);
-    texture2Collision[HASH("jump_l2r_0010", 0x750568e5)] =  CollisionZone(88,96,25,75, 0.);
-    texture2Collision[HASH("jump_l2r_0011", 0x40c86c9)] =  CollisionZone(85,95,24,83, 0.4);
-    texture2Collision[HASH("jump_l2r_0012", 0x903325ff)] =  CollisionZone(93,100,24,83, 0.2);
-    texture2Collision[HASH("jump_l2r_0013", 0x693e3cfa)] =  CollisionZone(110,119,25,64,-0.6);
-    texture2Collision[HASH("jump_l2r_0014", 0x6b426fdc)] =  CollisionZone(100, 120,21,60, -0.2);
-    texture2Collision[HASH("jump_l2r_0015", 0xeb11f32d)] =  CollisionZone(105, 115,22,62, -0.15);
-    texture2Collision[HASH("jump_l2r_0016", 0x79836412)] =  CollisionZone(103,103,24,66,-0.1);
-    for (int i=0; i<12; i++) {
+#if SAC_DEBUG
+    // collision zones are found by texture, make sure every runner frame has one
+    for (int i=0; i<RunnerCollision::JumpFrameCount; i++) {
+        std::stringstream a;
+        a << "jump_l2r_" << std::setfill('0') << std::setw(4) << i;
+        LOGF_IF(!RunnerCollision::find(theRenderingSystem.loadTextureFile(a.str().c_str()), false), "No collision zone for " << a.str());
+    }
+    for (int i=0; i<RunnerCollision::RunFrameCount; i++) {
         std::stringstream a;
         a << "run_l2r_" << std::setfill('0') << std::setw(4) << i;
-        texture2Collision[theRenderingSystem.loadTextureFile(a.str().c_str())] =  CollisionZone(118,103,35,88,-0.5);
+        LOGF_IF(!RunnerCollision::find(theRenderingSystem.loadTextureFile(a.str().c_str()), false), "No collision zone for " << a.str());
     }
+#endif
 
     //important! This must be called AFTER camera setup, since we are referencing it (anchor component)
     #if SAC_USE_PROPRIETARY_PLUGINS
@@ -508,6 +389,53 @@ void RecursiveRunnerGame::initGame() {
     #endif
 }
 
+#if SAC_BENCHMARK_MODE
+// Per-frame cost of RunnerSystem for 10, 100 and 1000 ghosts of a throwaway session: the path
+// runners take in game (SimulationBenchmark::runnerKinematics measures the kernel alone).
+// There's no platform: ghosts fall after their jump, which doesn't change the work done.
+static void benchmarkRunnerSystem(float baseLine) {
+    const float dt = 1.0f / param::SimulationTickRate;
+    const int frames = 5000;
+    const float halfLevel = RecursiveRunnerGame::levelLayout(param::LevelSize).width() * 0.5;
+
+    for (int count: { 10, 100, 1000 }) {
+        Entity session = theEntityManager.CreateEntity(HASH("session", 0xba9956b4), EntityType::Volatile);
+        ADD_COMPONENT(session, Session);
+        SessionComponent* sc = SESSION(session);
+        sc->jumps.init(count);
+        theRunnerSystem.preallocate(count);
+
+        SessionRandom random(count);
+        for (int i=0; i<count; i++) {
+            const float direction = (i % 2) ? -1 : 1;
+            Entity e = theRunnerSystem.spawnRunner();
+            RunnerComponent* rc = RUNNER(e);
+            rc->session = session;
+            rc->ghost = true;
+            rc->jumpTrack = sc->jumps.createTrack();
+            sc->jumps.push(rc->jumpTrack, random.Float(0, 1), random.Float(param::MinJumpDuration, param::MaxJumpDuration));
+            rc->startPoint = TRANSFORM(e)->position = glm::vec2(-direction * halfLevel, baseLine + TRANSFORM(e)->size.y * 0.5);
+            rc->endPoint = glm::vec2(direction * halfLevel, 0);
+            rc->speed = direction * param::speedConst;
+            rc->startTime = random.Float(0, 2);
+            sc->runners.push_back(e);
+        }
+
+        const float begin = TimeUtil::GetTime();
+        for (int f=0; f<frames; f++) {
+            theRunnerSystem.Update(dt);
+        }
+        std::cout << "RunnerSystem " << count << " ghosts: " << (TimeUtil::GetTime() - begin) * 1000000 / frames
+            << " us/frame" << std::endl;
+
+        for (unsigned i=0; i<sc->runners.size(); i++) {
+            theRunnerSystem.recycleRunner(sc->runners[i]);
+        }
+        theEntityManager.DeleteEntity(session);
+    }
+}
+#endif
+
 void RecursiveRunnerGame::init(const uint8_t* in, int size) {
     LOGI("RecursiveRunnerGame initialisation begins...");
 
@@ -515,16 +443,28 @@ void RecursiveRunnerGame::init(const uint8_t* in, int size) {
     gameThreadContext->storageAPI->init(gameThreadContext->assetAPI, "RecursiveRunner");
     gameThreadContext->storageAPI->setOption("sound", std::string(), "on");
     gameThreadContext->storageAPI->setOption("gameCount", std::string(), "0");
+    gameCount = ObjectSerializer<int>::string2object(gameThreadContext->storageAPI->getOption("gameCount"));
 
     {
         ScoreStorageProxy ssp;
         gameThreadContext->storageAPI->createTable(&ssp);
+        ScoreRollupStorageProxy srsp;
+        gameThreadContext->storageAPI->createTable(&srsp);
+        ScoreHistory::recover(gameThreadContext->storageAPI);
+        playedGames = ScoreHistory::loadTotals(gameThreadContext->storageAPI);
+
+        gameThreadContext->storageAPI->loadEntries(&ssp, "*",
+            "order by points desc limit " + ObjectSerializer<int>::object2string(topScores.getCapacity()));
+        topScores.load(ssp);
     }
 
     {
         statistics.allTimeBest = new Statistics();
         statistics.sessionBest = new Statistics();
         statistics.lastGame = new Statistics();
+        for (int i=0; i<3; i++) {
+            statistics.s[i]->reset(param::runner);
+        }
 
         StatsStorageProxy ssp(0);
         gameThreadContext->storageAPI->createTable(&ssp);
@@ -533,7 +473,9 @@ void RecursiveRunnerGame::init(const uint8_t* in, int size) {
         LOGI(ssp._queue.size());
         int index = 0;
         statistics.allTimeBest->score = 0;
-        while (! ssp.isEmpty() && index < 10) {
+        while (! ssp.isEmpty()) {
+            // best game may be an endless one
+            statistics.allTimeBest->grow(index + 1);
             statistics.allTimeBest->runner[index] = ssp._queue.front();
             ssp.popAnElement();
             statistics.allTimeBest->score += statistics.allTimeBest->runner[index].pointScored;
@@ -542,6 +484,18 @@ void RecursiveRunnerGame::init(const uint8_t* in, int size) {
         LOGI("BEST SCORE: " << statistics.allTimeBest->score);
     }
 
+    if (param::FittedCollisionZones) {
+        LOGI("\t- Load runner collision zones...");
+        // built by tools/extract_collision_zones.py; zones are read in place
+        FileBuffer fb = gameThreadContext->assetAPI->loadAsset("runner.collision");
+        if (RunnerCollision::use(fb.data, fb.size)) {
+            collisionTable = fb.data;
+        } else {
+            LOGW("Invalid or missing runner.collision, using built-in collision zones");
+            delete[] fb.data;
+        }
+    }
+
     LOGI("\t- Create camera...");
 
     successManager.init(this);
@@ -557,10 +511,28 @@ void RecursiveRunnerGame::init(const uint8_t* in, int size) {
     }
     updateBestScore();
 
+    // from now on the database is only written, in background
+    persistence.start(gameThreadContext->storageAPI);
+    persistence.push(ScoreHistory::compactTables);
+#if !SAC_EMSCRIPTEN
+    statsLogPath = gameThreadContext->assetAPI->getWritableAppDatasPath() + "/stats.log";
+    {
+        // older segments are deleted, leaving room for this app session one
+        const std::string replaysDirectory = gameThreadContext->assetAPI->getWritableAppDatasPath();
+        replaySegmentPath = Replay::segmentPath(replaysDirectory, time(0));
+        persistence.push([replaysDirectory] (StorageAPI*) -> void {
+            const unsigned deleted = Replay::pruneSegments(replaysDirectory, param::ReplaySegmentsKept - 1);
+            if (deleted)
+                LOGI(deleted << " old replay segments deleted");
+        });
+    }
+#endif
+
     sceneStateMachine.setup(gameThreadContext->assetAPI);
 
     //recover
     if (size > 0 && in) {
+        theRunnerSystem.rebuildPools();
         sceneStateMachine.start(Scene::Pause);
     } else {
 #if SAC_DEBUG
@@ -574,6 +546,14 @@ void RecursiveRunnerGame::init(const uint8_t* in, int size) {
    RecursiveRunnerDebugConsole::init(this);
 #endif
 
+#if SAC_BENCHMARK_MODE
+    benchmarkRunnerSystem(baseLine);
+    SimulationBenchmark::runnerKinematics();
+    SimulationBenchmark::coinPlacement();
+    SimulationBenchmark::statsLog();
+    SimulationBenchmark::sessionBatch();
+#endif
+
    LOGI("RecursiveRunnerGame initialisation done.");
 }
 
@@ -612,6 +592,10 @@ void RecursiveRunnerGame::togglePause(bool pause) {
     if (sceneStateMachine.getCurrentState() == Scene::Game && pause) {
         sceneStateMachine.forceNewState(Scene::Pause);
     }
+    // the app may be killed while paused
+    if (pause) {
+        flushPersistence();
+    }
 }
 
 void RecursiveRunnerGame::tick(float dt) {
@@ -622,19 +606,13 @@ void RecursiveRunnerGame::tick(float dt) {
             Cardinal::S).y;
 
     if (BUTTON(muteBtn)->clicked) {
-        //retrieve current state
-        bool muted =
-#if SAC_EMSCRIPTEN
-            false;
-#else
-            gameThreadContext->storageAPI->isOption("sound", "off");
-#endif
-
-        //and invert it
-        muted = ! muted;
+        //retrieve current state and invert it
+        const bool muted = ! theSoundSystem.mute;
 
         //then save it
-        gameThreadContext->storageAPI->setOption("sound", muted ? "off" : "on", "on");
+        persistence.push([muted] (StorageAPI* storage) -> void {
+            storage->setOption("sound", muted ? "off" : "on", "on");
+        });
         RENDERING(muteBtn)->texture = theRenderingSystem.loadTextureFile(muted ? "son-off" : "son-on");
 
         theSoundSystem.mute = muted;
@@ -679,11 +657,7 @@ void RecursiveRunnerGame::tick(float dt) {
     if (sceneStateMachine.getCurrentState() != Scene::Menu) {
         for (unsigned i=1; i<2 /* theRenderingSystem.cameras.size()*/; i++) {
             float& camPosX = TRANSFORM(cameraEntity)->position.x;
-            if (camPosX < - PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5)) {
-                camPosX = - PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5);
-            } else if (camPosX > PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5)) {
-                camPosX = PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5);
-            }
+            camPosX = glm::clamp(camPosX, theCameraTargetSystem.minX, theCameraTargetSystem.maxX);
             // TRANSFORM(silhouette)->position.X = TRANSFORM(route)->position.X = camPosX;
             TRANSFORM(cameraEntity)->position.x = camPosX;
             TRANSFORM(cameraEntity)->position.y = baseLine + TRANSFORM(cameraEntity)->size.y * 0.5;
@@ -714,16 +688,33 @@ void RecursiveRunnerGame::setupCamera(CameraMode::Enum mode) {
 }
 
 void RecursiveRunnerGame::updateBestScore() {
-    ScoreStorageProxy ssp;
-    gameThreadContext->storageAPI->loadEntries(&ssp, "points", "order by points desc limit 1");
-    if (! ssp.isEmpty()) {
-        TEXT(bestScore)->text = gameThreadContext->localizeAPI->text("Best") + ": " + ObjectSerializer<int>::object2string(ssp._queue.front().points);
+    if (! topScores.empty()) {
+        TEXT(bestScore)->text = gameThreadContext->localizeAPI->text("Best") + ": " + ObjectSerializer<int>::object2string(topScores.best().points);
     } else {
         LOGW("No best score found (?!)");
         TEXT(bestScore)->text = "";
     }
 }
 
+unsigned RecursiveRunnerGame::saveScore(int points, int coins) {
+    std::shared_ptr<ScoreStorageProxy> ssp(new ScoreStorageProxy());
+    ssp->setValue("points", ObjectSerializer<int>::object2string(points), true); // ask to create a new score
+    ssp->setValue("coins", ObjectSerializer<int>::object2string(coins), false);
+    ssp->setValue("name", "rzehtrtyBg", false);
+    ssp->setValue("day", ObjectSerializer<int>::object2string(ScoreHistory::today()), false);
+    // no need to read it back (and the proxy belongs to the persistence queue once pushed)
+    const unsigned rank = topScores.insert(ssp->_queue.back());
+    ScoreHistory::add(playedGames, ssp->_queue.back());
+    if (rank == 0) {
+        updateBestScore();
+    }
+
+    persistence.push([ssp] (StorageAPI* storage) -> void {
+        storage->saveEntries(ssp.get());
+    });
+    return rank;
+}
+
 int RecursiveRunnerGame::saveState(uint8_t** ) {
     switch (sceneStateMachine.getCurrentState()) {
         case Scene::Game:
@@ -731,12 +722,21 @@ int RecursiveRunnerGame::saveState(uint8_t** ) {
         case Scene::Pause:
             break;
         default:
-            return 0;
+            break;
     }
+    flushPersistence();
     return 0;
 }
 
-static std::vector<glm::vec2> generateCoinsCoordinates(int count, float heightMin, float heightMax);
+void RecursiveRunnerGame::flushPersistence() {
+    // the stats log is written by blocks of games, the last one being written now
+    if (!statsLogPath.empty()) {
+        persistence.push([this] (StorageAPI*) -> void {
+            statsLog.append(statsLogPath);
+        });
+    }
+    persistence.flush();
+}
 
 static hash_t computeSeed() {
     time_t t = time(NULL);
@@ -750,59 +750,95 @@ static hash_t computeSeed() {
     return seed;
 }
 
-void RecursiveRunnerGame::startGame(Level::Enum level, bool transition) {
-    LOGF_IF(theSessionSystem.entityCount() != 0, "Incoherent state. " << theSessionSystem.entityCount() << " sessions existing");
-    LOGF_IF(thePlayerSystem.entityCount() != 0, "Incoherent state. " << thePlayerSystem.entityCount() << " players existing");
+Entity RecursiveRunnerGame::startGame(Level::Enum level, bool transition) {
+    const float startTime = TimeUtil::GetTime();
 
-    hash_t seed = computeSeed();
+    // Create session
+    Entity session = theEntityManager.CreateEntity(HASH("session", 0xba9956b4), EntityType::Persistent);
+    ADD_COMPONENT(session, Session);
+    SessionComponent* sc = SESSION(session);
+    sc->numPlayers = 1;
 
-    Random::Init(seed);
+    sc->seed = computeSeed();
+    sc->level = level;
+    sc->random.init(sc->seed);
 
-    const auto coinsPosition = generateCoinsCoordinates(20, PlacementHelper::GimpYToScreen(700), PlacementHelper::GimpYToScreen(450));
+    sc->levelSize = (level == Level::Long) ? param::LongLevelSize : param::LevelSize;
+    sc->streamed = true;
+
+    std::vector<glm::vec3> platforms;
+    if (level == Level::Level3) {
+        platforms = LevelChunks::generatePlatforms(sc->random, param::PlatformCount, param::PlatformRows,
+            PlacementHelper::GimpYToScreen(680), PlacementHelper::GimpYToScreen(380),
+            param::LevelSize * PlacementHelper::ScreenSize.x);
+    }
     if (level != Level::Level2) {
-        // we only want coin position to be identical
-        Random::Init(time(0));
+        // we only want coins position (from seed, see LevelChunks) and start times to be identical
+        sc->random.init(time(0));
     }
 
-    for (int i=0; i<100; i++) {
-        nextRunnerStartTime[i] = Random::Float(0.0f, 2.0f);
+    // more are drawn if needed (see RunnerSystem). Quantized: replays store them in ticks
+    sc->nextRunnerStartTime.resize(100);
+    for (unsigned i=0; i<sc->nextRunnerStartTime.size(); i++) {
+        sc->nextRunnerStartTime[i] = Replay::quantize(sc->random.Float(0.0f, 2.0f));
     }
-    nextRunnerStartTimeIndex = 0;
+    sc->nextRunnerStartTimeIndex = 0;
+    sc->stats.reset(param::runner * sc->numPlayers);
+
+    // every jump track is allocated now
+    const int runnerCount = (level == Level::Endless) ? param::EndlessPreallocatedRunners : param::runner;
+    sc->jumps.init(runnerCount * sc->numPlayers, JumpTrackArena::jumpsPerTrackFor(sc->levelSize));
+    // and every runner entity
+    theRunnerSystem.preallocate(runnerCount * sc->numPlayers);
 
-    // Create session
-    Entity session = theEntityManager.CreateEntity(HASH("session", 0xba9956b4), EntityType::Persistent);
-    ADD_COMPONENT(session, Session);
-    SessionComponent* sc = SESSION(session);
-    sc->numPlayers = 1;
     // Create player
     Entity player = theEntityManager.CreateEntity(HASH("player", 0x9881cf14), EntityType::Persistent);
     ADD_COMPONENT(player, Player);
     sc->players.push_back(player);
     PlayerComponent* pc = PLAYER(player);
-    #define COLOR(n) Color(((0x##n >> 16) & 0xff) / 255.0, ((0x##n >> 8) & 0xff) / 255.0, ((0x##n >> 0) & 0xff) / 255.0, 1.0)
-    pc->colors.push_back(COLOR(c30101));
-    pc->colors.push_back(COLOR(ea6c06));
-    pc->colors.push_back(COLOR(f4cf00));
-    pc->colors.push_back(COLOR(8ec301));
-    pc->colors.push_back(COLOR(01c373));
-    pc->colors.push_back(COLOR(12bbd9));
-    pc->colors.push_back(COLOR(1e49d7));
-    pc->colors.push_back(COLOR(5d00bd));
-    pc->colors.push_back(COLOR(a910db));
-    pc->colors.push_back(COLOR(dc52b0));
-
-    switch (level) {
-        case Level::Level1:
-            createCoins(coinsPosition, sc, transition);
-            break;
-        case Level::Level2:
-            createCoins(coinsPosition, sc, transition);
-            break;
+    addRunnerColors(pc->colors, 0);
+
+    // coins of the first screens, the others come with the camera. Their entities are
+    // pooled: streamLevel keeps at most 5 chunks alive.
+    const unsigned coinEntities = 5 * param::CoinsPerChunk;
+    coinEntityPool.preallocate(CoinEntity::Coin, coinEntities);
+    coinEntityPool.preallocate(CoinEntity::Gain, coinEntities);
+    coinEntityPool.preallocate(CoinEntity::Link, coinEntities + 1);
+    coinEntityPool.preallocate(CoinEntity::Sparkling, coinEntities + 1);
+    const LevelLayout layout = levelLayout(sc->levelSize);
+    theCameraTargetSystem.minX = layout.left + PlacementHelper::ScreenSize.x * 0.5;
+    theCameraTargetSystem.maxX = layout.right() - PlacementHelper::ScreenSize.x * 0.5;
+    sc->renderGroup.setAlpha(transition ? 0 : 1);
+    streamLevel(sc, theCameraTargetSystem.minX);
+
+    if (level == Level::Level3) {
+        createPlatforms(platforms, sc);
     }
+    const float duration = (TimeUtil::GetTime() - startTime) * 1000;
+    LOGI("Game started in " << duration << " ms");
+#if SAC_BENCHMARK_MODE
+    // benchmark mode restarts games back to back: report startGame latency over the run
+    static int startCount = 0;
+    static float totalDuration = 0, maxDuration = 0;
+    startCount++;
+    totalDuration += duration;
+    maxDuration = glm::max(maxDuration, duration);
+    std::cout << "START GAME #" << startCount << ' ' << duration << " ms (avg "
+        << totalDuration / startCount << " ms, max " << maxDuration << " ms)" << std::endl;
+#endif
+    return session;
+}
 
-    if (level == Level::Level2) {
-        // restore whatever seed
-        Random::Init(time(0));
+void RecursiveRunnerGame::addRunnerColors(std::vector<Color>& colors, int round) {
+    #define COLOR(n) Color(((0x##n >> 16) & 0xff) / 255.0, ((0x##n >> 8) & 0xff) / 255.0, ((0x##n >> 0) & 0xff) / 255.0, 1.0)
+    static const Color palette[] = {
+        COLOR(c30101), COLOR(ea6c06), COLOR(f4cf00), COLOR(8ec301), COLOR(01c373),
+        COLOR(12bbd9), COLOR(1e49d7), COLOR(5d00bd), COLOR(a910db), COLOR(dc52b0),
+    };
+    #undef COLOR
+    const float shade = glm::max(0.4f, 1.0f - 0.15f * round);
+    for (const Color& c: palette) {
+        colors.push_back(Color(c.r * shade, c.g * shade, c.b * shade, 1.0));
     }
 }
 
@@ -812,191 +848,324 @@ bool RecursiveRunnerGame::statisticsAvailable() const {
         statistics.lastGame->score > 0;
 }
 
+// adds the session to this app session replays segment. Replays of previous app sessions
+// are left untouched: the segment only holds the replays played since startup.
+// Runs on the persistence thread (only user of the segment).
+static void saveReplay(ReplayArchiveWriter& segment, const std::string& path, const ReplayData& replay) {
+    segment.add(replay);
+    if (segment.save(path)) {
+        LOGI("Replay saved (" << segment.count() << " replays in '" << path << "')");
+    }
+}
+
 void RecursiveRunnerGame::endGame(Statistics* stats) {
 /*todo:
  TextureInfo à revisiter (et si possible rotateUV à dégager)
  ne pas faire un lookup 2 fois (une fois dans Update, une fois dans Render)*/
-    const auto& sessions = theSessionSystem.RetrieveAllEntityWithComponent();
-    if (!sessions.empty()) {
-        SessionComponent* sc = SESSION(sessions.front());
+    // copied: sessions are deleted on the way
+    const std::vector<Entity> sessions = theSessionSystem.RetrieveAllEntityWithComponent();
+    for (unsigned s=0; s<sessions.size(); s++) {
+        SessionComponent* sc = SESSION(sessions[s]);
 
-        /* store stats */
+        /* store stats (returned ones, and best scores, are the first session ones) */
         if (stats) {
-            memset(stats, 0, sizeof(Statistics));
-            const auto& players = thePlayerSystem.RetrieveAllEntityWithComponent();
-            stats->score = PLAYER(players.front())->points;
-
-            for(unsigned i=0; i<10; i++) {
-                stats->runner[i] = sc->stats.runner[i];
-                stats->color[i] = sc->stats.color[i];
+            Statistics game = sc->stats;
+            game.score = PLAYER(sc->players.front())->points;
+            if (s == 0) {
+                *stats = game;
+                recordBestStats(game);
             }
 
-            /* store as best stats */
-            #if SAC_BENCHMARK_MODE
-            if (1) {
-            #else
-            if (stats->score > statistics.allTimeBest->score) {
-            #endif
-                #if SAC_BENCHMARK_MODE
-                Random::Init(time(0) * stats->score);
-                #endif
-                int gameId = Random::Int(0, INT_MAX);
-                StatsStorageProxy ssp(gameId);
-
-                #if SAC_BENCHMARK_MODE
-                static int gameCount = 0;
-                std::cout << "END GAME #" << gameCount++ <<  ' ' << gameId << std::endl;
-                #else
-                gameThreadContext->storageAPI->dropAll(&ssp);
-                #endif
-
-                for (int i=0; i<10; i++) {
-                    ssp._queue.push(stats->runner[i]);
-                }
-                gameThreadContext->storageAPI->saveEntries(&ssp);
-
-                memcpy(statistics.allTimeBest, stats, sizeof(Statistics));
+            /* and every game in the stats log */
+            if (!statsLogPath.empty()) {
+                const int gameLevel = sc->level;
+                const uint32_t end = time(0);
+                persistence.push([this, game, gameLevel, end] (StorageAPI*) -> void {
+                    statsLog.add(game, gameLevel, end);
+                    if (statsLog.pendingRows() >= StatsLog::BlockRows) {
+                        statsLog.append(statsLogPath);
+                    }
+                });
             }
-            if (stats->score > statistics.sessionBest->score) {
-                memcpy(statistics.sessionBest, statistics.lastGame, sizeof(Statistics));
+
+            #if !SAC_EMSCRIPTEN && !SAC_BENCHMARK_MODE
+            {
+                // copied now: the session is deleted below
+                std::shared_ptr<ReplayData> replay(new ReplayData());
+                replay->seed = sc->seed;
+                replay->level = sc->level;
+                replay->score = game.score;
+                replay->runnerStartTimes.assign(sc->nextRunnerStartTime.begin(),
+                    sc->nextRunnerStartTime.begin() + sc->nextRunnerStartTimeIndex);
+                replay->jumps = sc->jumps;
+                persistence.push([this, replay] (StorageAPI*) -> void {
+                    saveReplay(replaySegment, replaySegmentPath, *replay);
+                });
             }
+            #endif
         }
 
-
+        // whole group is left at once (recycled runners would leave it one by one)
+        sc->renderGroup.clear();
         for(unsigned i=0; i<sc->runners.size(); i++)
-            theEntityManager.DeleteEntity(RUNNER(sc->runners[i])->collisionZone);
-        std::for_each(sc->runners.begin(), sc->runners.end(), deleteEntityFunctor);
-        std::for_each(sc->coins.begin(), sc->coins.end(), deleteEntityFunctor);
+            theRunnerSystem.recycleRunner(sc->runners[i]);
+        releaseCoinEntities(sc, 0, sc->coins.size());
+        // stops the coins generator
+        sc->streamer.reset();
         std::for_each(sc->players.begin(), sc->players.end(), deleteEntityFunctor);
-        std::for_each(sc->links.begin(), sc->links.end(), deleteEntityFunctor);
-        std::for_each(sc->sparkling.begin(), sc->sparkling.end(), deleteEntityFunctor);
-        std::for_each(sc->gains.begin(), sc->gains.end(), deleteEntityFunctor);
-        theEntityManager.DeleteEntity(sessions.front());
+        for (unsigned i=0; i<sc->platforms.size(); i++) {
+            theEntityManager.DeleteEntity(sc->platforms[i].platform);
+            theEntityManager.DeleteEntity(sc->platforms[i].switches[0].entity);
+            theEntityManager.DeleteEntity(sc->platforms[i].switches[1].entity);
+        }
+        theEntityManager.DeleteEntity(sessions[s]);
+    }
+    if (!sessions.empty()) {
+        theRunnerSystem.recycleKillAnimations();
+        thePlatformerSystem.clearPlatforms();
     }
     // on supprime aussi tous les trucs temporaires (lumières, ...)
     const auto temp = theAutoDestroySystem.RetrieveAllEntityWithComponent();
     std::for_each(temp.begin(), temp.end(), deleteEntityFunctor);
 }
 
+void RecursiveRunnerGame::recordBestStats(const Statistics& game) {
+    /* store as best stats */
+    #if SAC_BENCHMARK_MODE
+    if (1) {
+    #else
+    if (game.score > statistics.allTimeBest->score) {
+    #endif
+        #if SAC_BENCHMARK_MODE
+        Random::Init(time(0) * game.score);
+        #endif
+        int gameId = Random::Int(0, INT_MAX);
+        std::shared_ptr<StatsStorageProxy> ssp(new StatsStorageProxy(gameId));
 
-static bool sortLeftToRight(Entity e, Entity f) {
-    return TRANSFORM(e)->position.x < TRANSFORM(f)->position.x;
-}
-
-static std::vector<glm::vec2> generateCoinsCoordinates(int count, float heightMin, float heightMax) {
-    std::vector<glm::vec2> positions;
+        #if SAC_BENCHMARK_MODE
+        static int gameCount = 0;
+        std::cout << "END GAME #" << gameCount++ <<  ' ' << gameId << std::endl;
+        #endif
 
-    int available = 0;
-    float* randomX = new float[count];
-    float* randomY = new float[count];
+        for (unsigned i=0; i<game.runner.size(); i++) {
+            ssp->_queue.push(game.runner[i]);
+        }
+        // only the best game stats are kept
+        persistence.push([ssp] (StorageAPI* storage) -> void {
+            #if !SAC_BENCHMARK_MODE
+            storage->dropAll(ssp.get());
+            #endif
+            storage->saveEntries(ssp.get());
+        });
 
+        *statistics.allTimeBest = game;
+    }
+    if (game.score > statistics.sessionBest->score) {
+        *statistics.sessionBest = *statistics.lastGame;
+    }
+}
 
-    for (int i=0; i<count; i++) {
-        glm::vec2 p;
-        bool notFarEnough = true;
 
-        do {
-            if (available == 0) {
-                // initialize random
-                Random::N_Floats(count, randomX,
-                    -param::LevelSize * 0.5 * PlacementHelper::ScreenSize.x + 1,
-                    param::LevelSize * 0.5 * PlacementHelper::ScreenSize.x - 1);
+void RecursiveRunnerGame::createPlatforms(const std::vector<glm::vec3>& platforms, SessionComponent* session) {
+    LOGI("Platforms creation started");
+
+    EntityTemplateRef platformTemplate = theEntityManager.entityTemplateLibrary.load("ingame/platform");
+    EntityTemplateRef switchTemplate = theEntityManager.entityTemplateLibrary.load("ingame/switch");
+
+    session->platforms.resize(platforms.size());
+    for (unsigned i=0; i<platforms.size(); i++) {
+        Platform& pt = session->platforms[i];
+
+        pt.platform = theEntityManager.CreateEntity(HASH("platform/platform", 0xe89c4e),
+            EntityType::Persistent, platformTemplate);
+        TransformationComponent* tc = TRANSFORM(pt.platform);
+        // same boxes as SessionSimulator ones
+        const RunnerRules::Box platformBox = RunnerRules::platformBox(platforms[i], tc->size.y);
+        tc->size.x = platformBox.size.x;
+        tc->position = platformBox.position;
+        session->renderGroup.add(pt.platform);
+
+        // switches hang under both ends: the same runner has to jump through both of them
+        for (unsigned l=0; l<2; l++) {
+            Entity sw = theEntityManager.CreateEntity(HASH("platform/switch", 0xb2bd2ef9),
+                EntityType::Persistent, switchTemplate);
+            TRANSFORM(sw)->position = RunnerRules::switchBox(platforms[i], l, tc->size.y, TRANSFORM(sw)->size).position;
+            session->renderGroup.add(sw);
+            pt.switches[l].entity = sw;
+        }
+    }
+    LOGI("Platforms creation finished (" << platforms.size() << ')');
+}
 
-                Random::N_Floats(count, randomY, heightMin, heightMax);
+static glm::vec2 coinEntitySize() {
+    // ingame/coin.entity, scaled in createCoinEntities
+    return glm::vec2(PlacementHelper::GimpWidthToScreen(99), PlacementHelper::GimpHeightToScreen(107)) * param::CoinScale;
+}
 
-                available = count;
-            }
+// placeholder for coins of chunks not generated yet
+static const float UnknownCoinY = -1000;
 
-            p = glm::vec2(randomX[available - 1], randomY[available - 1]);
-            available--;
+void RecursiveRunnerGame::createCoins(const std::vector<glm::vec2>& coordinates, SessionComponent* session) {
+    LOGI("Coins creation started");
 
-            notFarEnough = false;
-            for (unsigned j = 0; j < positions.size() && !notFarEnough; j++) {
-                if (glm::abs(positions[j].x - p.x) < 1) {
-                    notFarEnough = true;
-                }
-            }
-        } while (notFarEnough);
-        positions.push_back(p);
-    }
+    releaseCoinEntities(session, 0, session->coins.size());
+    session->streamed = false;
+    session->coinPositions = coordinates;
+    std::sort(session->coinPositions.begin(), session->coinPositions.end(), [] (const glm::vec2& a, const glm::vec2& b) -> bool {
+        return a.x < b.x;
+    });
+    session->coinSize = coinEntitySize();
+    session->coins.assign(coordinates.size(), 0);
+    session->gains.assign(coordinates.size(), 0);
+    session->links.assign(coordinates.size() + 1, 0);
+    session->sparkling.assign(coordinates.size() + 1, 0);
+    createCoinEntities(session, 0, coordinates.size());
 
-    delete[] randomX;
-    delete[] randomY;
+    LOGI("Coins creation finished");
+}
 
-    return positions;
+LevelLayout RecursiveRunnerGame::levelLayout(int levelSize) {
+    return LevelLayout(-PlacementHelper::ScreenSize.x * param::LevelSize * 0.5, PlacementHelper::ScreenSize.x,
+        levelSize, param::CoinsPerChunk, PlacementHelper::GimpYToScreen(700), PlacementHelper::GimpYToScreen(450));
 }
 
-static Entity createGainEntity(Entity parent, const Color& color) {
-    Entity e = theEntityManager.CreateEntityFromTemplate("ingame/gain");
+void RecursiveRunnerGame::streamLevel(SessionComponent* session, float cameraX) {
+    const LevelLayout layout = levelLayout(session->levelSize);
+    const int coinsPerChunk = layout.coinsPerChunk;
+
+    if (!session->streamer) {
+        session->streamer.reset(new LevelStreamer());
+    }
+    LevelStreamer& levelStreamer = *session->streamer;
+    if (!levelStreamer.isStarted(session->seed, layout) || (int)session->coinPositions.size() != layout.coinCount()) {
+        LOGI("Level streaming starts: " << layout.chunkCount << " chunks");
+        levelStreamer.start(session->seed, layout);
+        // unknown coins can't be picked, and keep coins sorted
+        session->coinPositions.resize(layout.coinCount());
+        for (int i=0; i<layout.coinCount(); i++) {
+            session->coinPositions[i] = glm::vec2(layout.left + (i / coinsPerChunk) * layout.chunkWidth, UnknownCoinY);
+        }
+        session->coinSize = coinEntitySize();
+        session->coins.resize(layout.coinCount(), 0);
+        session->gains.resize(layout.coinCount(), 0);
+        session->links.resize(layout.coinCount() + 1, 0);
+        session->sparkling.resize(layout.coinCount() + 1, 0);
+    }
 
-    TRANSFORM(e)->position = TRANSFORM(parent)->position;
-    TRANSFORM(e)->rotation = TRANSFORM(parent)->rotation;
-    TRANSFORM(e)->size = TRANSFORM(parent)->size;
-    TRANSFORM(e)->z = TRANSFORM(parent)->z + 0.1;
+    // chunks on screen must be known now, the next ones are generated in background
+    // (runners come from both level ends, so they are ahead on both sides)
+    const int current = layout.chunkAt(cameraX);
+    for (int c=current - 2; c<=current + 2; c++) {
+        levelStreamer.request(c);
+    }
+    for (int c=glm::max(0, current - 1); c<=glm::min(layout.chunkCount - 1, current + 1); c++) {
+        if (session->coinPositions[c * coinsPerChunk].y == UnknownCoinY)
+            levelStreamer.wait(c);
+    }
+    std::vector<int> generated;
+    levelStreamer.collect(generated);
+    for (int c: generated) {
+        std::copy(levelStreamer.coins(c), levelStreamer.coins(c) + coinsPerChunk,
+            session->coinPositions.begin() + c * coinsPerChunk);
+    }
 
-    PARTICULE(parent)->initialColor = PARTICULE(parent)->finalColor = Interval<Color> (color, color);
-    return e;
+    for (int c=0; c<layout.chunkCount; c++) {
+        const int first = c * coinsPerChunk, last = first + coinsPerChunk;
+        const bool hasEntities = (session->coins[first] != 0);
+        if (glm::abs(c - current) > 2) {
+            // behind the camera
+            if (hasEntities)
+                releaseCoinEntities(session, first, last);
+        } else if (!hasEntities && glm::abs(c - current) <= 1) {
+            // first link starts on the previous chunk last coin
+            const bool known = session->coinPositions[first].y != UnknownCoinY &&
+                (c == 0 || session->coinPositions[first - 1].y != UnknownCoinY);
+            if (known)
+                createCoinEntities(session, first, last);
+        }
+    }
 }
 
-void RecursiveRunnerGame::createCoins(const std::vector<glm::vec2>& coordinates, SessionComponent* session, bool transition) {
-    LOGI("Coins creation started");
+void RecursiveRunnerGame::createCoinEntities(SessionComponent* session, int first, int last) {
+    const int count = session->coinPositions.size();
+    const LevelLayout layout = levelLayout(session->streamed ? session->levelSize : param::LevelSize);
+    const glm::vec2 offset = glm::vec2(0, PlacementHelper::GimpHeightToScreen(14));
 
-    EntityTemplateRef coinTemplate = theEntityManager.entityTemplateLibrary.load("ingame/coin");
-    EntityTemplateRef linkTemplate = theEntityManager.entityTemplateLibrary.load("ingame/link");
-    EntityTemplateRef link3Template = theEntityManager.entityTemplateLibrary.load("ingame/link3");
+    // link i ends on coin i, the last one on the level end
+    const int lastLink = (last == count) ? count : last - 1;
+    const EntitySpan coins = coinEntityPool.acquire(CoinEntity::Coin, last - first);
+    for (int i=first; i<last; i++) {
+        Entity e = coins[i - first];
+        TransformationComponent* tc = TRANSFORM(e);
+        tc->size *= param::CoinScale;
+        tc->position = session->coinPositions[i];
 
-    std::vector<Entity> coins;
-    for (unsigned i=0; i<coordinates.size(); i++) {
-        /* Create coin */
-        Entity e = theEntityManager.CreateEntity(HASH("coin/coin", 0x38fb9dd5),
-            EntityType::Persistent, coinTemplate);
+        session->renderGroup.add(e);
+        session->coins[i] = e;
 
-        TRANSFORM(e)->size *= param::CoinScale;
-        TRANSFORM(e)->position = coordinates[i];
+        Color c(RENDERING(e)->color);
+        c.a = 1.0f;
+        PARTICULE(e)->initialColor = PARTICULE(e)->finalColor = Interval<Color> (c, c);
+    }
 
-        RENDERING(e)->color.a = (transition ? 0 : 1);
+    const EntitySpan gains = coinEntityPool.acquire(CoinEntity::Gain, last - first);
+    for (int i=first; i<last; i++) {
+        const TransformationComponent* parent = TRANSFORM(session->coins[i]);
+        TransformationComponent* tc = TRANSFORM(gains[i - first]);
+        tc->position = parent->position;
+        tc->rotation = parent->rotation;
+        tc->size = parent->size;
+        tc->z = parent->z + 0.1;
+        session->gains[i] = gains[i - first];
+    }
 
-        coins.push_back(e);
+    const int linkCount = glm::max(0, lastLink - first + 1);
+    const EntitySpan links = coinEntityPool.acquire(CoinEntity::Link, linkCount);
+    const EntitySpan sparkling = coinEntityPool.acquire(CoinEntity::Sparkling, linkCount);
+    for (int i=first; i<=lastLink; i++) {
+        const glm::vec2 previous = (i > 0) ?
+            session->coinPositions[i - 1] + offset :
+            glm::vec2(layout.left, -PlacementHelper::ScreenSize.y * 0.2);
+        const glm::vec2 topI = (i < count) ?
+            session->coinPositions[i] + offset :
+            glm::vec2(layout.right(), 0);
+
+        Entity link = links[i - first];
+        TransformationComponent* tc = TRANSFORM(link);
+        tc->position = (topI + previous) * 0.5f;
+        tc->size = glm::vec2(glm::length(topI - previous), PlacementHelper::GimpHeightToScreen(54));
+        tc->rotation = -/*glm::radians*/(glm::orientedAngle(glm::normalize(topI - previous), glm::vec2(1.0f, 0.0f)));
+        session->renderGroup.add(link);
+
+        Entity link3 = sparkling[i - first];
+        TRANSFORM(link3)->size = tc->size * glm::vec2(1, 0.1);
+        AnchorComponent* ac = ANCHOR(link3);
+        ac->parent = link;
+        ac->position = glm::vec2(0, tc->size.y * 0.4);
+        PARTICULE(link3)->emissionRate = 100 * tc->size.x * tc->size.y;
+
+        session->links[i] = link;
+        session->sparkling[i] = link3;
     }
+}
 
-    std::sort(coins.begin(), coins.end(), sortLeftToRight);
-    const glm::vec2 offset = glm::vec2(0, PlacementHelper::GimpHeightToScreen(14));
-    glm::vec2 previous = glm::vec2(-param::LevelSize * PlacementHelper::ScreenSize.x * 0.5, -PlacementHelper::ScreenSize.y * 0.2);
-    for (unsigned i = 0; i <= coins.size(); i++) {
-        glm::vec2 topI;
-
-        if (i < coins.size())
-            topI = TRANSFORM(coins[i])->position + glm::rotate(offset, TRANSFORM(coins[i])->rotation);
-        else
-            topI = glm::vec2(param::LevelSize * PlacementHelper::ScreenSize.x * 0.5, 0);
-
-        Entity link = theEntityManager.CreateEntity(HASH("link/normal", 0xf4f248b8),
-            EntityType::Persistent, linkTemplate);
-        TRANSFORM(link)->position = (topI + previous) * 0.5f;
-        TRANSFORM(link)->size = glm::vec2(glm::length(topI - previous), PlacementHelper::GimpHeightToScreen(54));
-        TRANSFORM(link)->rotation = -/*glm::radians*/(glm::orientedAngle(glm::normalize(topI - previous), glm::vec2(1.0f, 0.0f)));
-        RENDERING(link)->color.a =  (transition ? 0 : 1);
-
-        Entity link3 = theEntityManager.CreateEntity(HASH("link/particule", 0x5c2067ee),
-            EntityType::Persistent, link3Template);
-        TRANSFORM(link3)->size = TRANSFORM(link)->size * glm::vec2(1, 0.1);
-        ANCHOR(link3)->parent = link;
-        ANCHOR(link3)->position = glm::vec2(0, TRANSFORM(link)->size.y * 0.4);
-        PARTICULE(link3)->emissionRate = 100 * TRANSFORM(link)->size.x * TRANSFORM(link)->size.y;
-        session->sparkling.push_back(link3);
-
-        previous = topI;
-        session->links.push_back(link);
-    }
-
-    for (unsigned i=0; i<coins.size(); i++) {
-        session->coins.push_back(coins[i]);
-
-        /* Create gain */
-        Color c(RENDERING(coins[i])->color);
-        c.a = 1.0f;
-        Entity gain = createGainEntity(coins[i], c);
-        session->gains.push_back(gain);
+void RecursiveRunnerGame::releaseCoinEntities(SessionComponent* session, int first, int last) {
+    const int count = session->coins.size();
+    for (int i=first; i<last; i++) {
+        if (session->coins[i]) {
+            session->renderGroup.remove(session->coins[i]);
+            coinEntityPool.release(CoinEntity::Coin, session->coins[i]);
+            coinEntityPool.release(CoinEntity::Gain, session->gains[i]);
+            session->coins[i] = session->gains[i] = 0;
+        }
+    }
+    const int lastLink = (last == count) ? count : last - 1;
+    for (int i=first; i<=lastLink && i<(int)session->links.size(); i++) {
+        if (session->links[i]) {
+            coinEntityPool.release(CoinEntity::Sparkling, session->sparkling[i]);
+            session->renderGroup.remove(session->links[i]);
+            coinEntityPool.release(CoinEntity::Link, session->links[i]);
+            session->links[i] = session->sparkling[i] = 0;
+        }
     }
-    LOGI("Coins creation finished");
 }
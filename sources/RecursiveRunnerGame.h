@@ -28,14 +28,22 @@
 #include "systems/RenderingSystem.h"
 #include "systems/SessionSystem.h"
 
+#include "simulation/LevelChunks.h"
+#include "simulation/StatsLog.h"
+#include "simulation/Replay.h"
+
 #include "api/AdAPI.h"
 #include "api/ExitAPI.h"
 #include "api/CommunicationAPI.h"
 
 #include "util/GameCenterAPIHelper.h"
 #include "util/SuccessManager.h"
+#include "util/CoinEntityPool.h"
+#include "util/PersistenceQueue.h"
+#include "util/TopScores.h"
 
 #include "scenes/Scenes.h"
+#include "Level.h"
 
 #include "base/StateMachine.h"
 class NameInputAPI;
@@ -49,12 +57,6 @@ namespace CameraMode {
     };
 }
 
-namespace Level {
-    enum Enum {
-        Level1,
-        Level2
-    };
-}
 
 
 
@@ -64,7 +66,8 @@ class RecursiveRunnerGame : public Game {
 #endif
 
    public:
-      static void startGame(Level::Enum level, bool transition);
+      Entity startGame(Level::Enum level, bool transition);
+      // ends every session
       void endGame(Statistics* stat);
 
    public:
@@ -83,13 +86,20 @@ class RecursiveRunnerGame : public Game {
 
       int saveState(uint8_t** out) override;
       void setupCamera(CameraMode::Enum mode);
+      // best score banner, from topScores
       void updateBestScore();
+      // returns the score rank in topScores
+      unsigned saveScore(int points, int coins);
 
       bool statisticsAvailable() const;
 
    private:
       void decor();
       void initGame();
+      // waits for pending database and stats log writes
+      void flushPersistence();
+      // best games statistics (see endGame)
+      void recordBestStats(const Statistics& game);
 
 
     private:
@@ -131,10 +141,42 @@ class RecursiveRunnerGame : public Game {
             };
         } statistics;
 
-        static float nextRunnerStartTime[100];
-        static int nextRunnerStartTimeIndex;
-
-        static void createCoins(const std::vector<glm::vec2>& coordinates, SessionComponent* session, bool transition);
+        // database writes (see PersistenceQueue: the database isn't read after init)
+        PersistenceQueue persistence;
+        int gameCount;
+        // loaded at init, then updated by saveScore
+        TopScores topScores;
+        // every game played (see ScoreHistory::totals), same
+        ScoreRollup playedGames;
+        // statistics of every game (see StatsLog), only used by the persistence queue
+        StatsLogWriter statsLog;
+        std::string statsLogPath;
+        // replays of this app session (see Replay.h), only used by the persistence queue
+        ReplayArchiveWriter replaySegment;
+        std::string replaySegmentPath;
+
+        // runner collision zones table (see RunnerCollision::use)
+        uint8_t* collisionTable;
+
+        void createCoins(const std::vector<glm::vec2>& coordinates, SessionComponent* session);
+        // platforms are (center x, top y, width)
+        void createPlatforms(const std::vector<glm::vec3>& platforms, SessionComponent* session);
+
+        // levels start at the same place whatever their size (levelSize screens), and are
+        // made of chunks of one screen
+        static LevelLayout levelLayout(int levelSize);
+        // streamed levels: asks for the coins of the chunks around cameraX (generated in
+        // background), creates their entities, and releases the entities of the other chunks
+        void streamLevel(SessionComponent* session, float cameraX);
+        // entities of coins [first, last) and of the links ending on them (and of the last
+        // link, if last is the level end)
+        void createCoinEntities(SessionComponent* session, int first, int last);
+        void releaseCoinEntities(SessionComponent* session, int first, int last);
+        // shared by every session
+        CoinEntityPool coinEntityPool;
+    public:
+        // adds the runners palette to colors, darker for each round (endless sessions use it again and again)
+        static void addRunnerColors(std::vector<Color>& colors, int round);
 };
 
 #define SCENE_TUTORIAL (Scene::Enum)42
@@ -42,28 +42,50 @@
 #include "systems/CameraTargetSystem.h"
 #include "systems/SessionSystem.h"
 #include "systems/PlatformerSystem.h"
+#include "systems/RangeFollowerSystem.h"
 #include "api/LocalizeAPI.h"
 
 #include "../RecursiveRunnerGame.h"
 #include "../Parameters.h"
+#include "../simulation/CoinSweep.h"
+#include "../simulation/RunnerRules.h"
 
 #include <glm/gtx/compatibility.hpp>
 #include <cmath>
 #include <iostream>
 
-static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, PlayerComponent* p, int playerIndex, SessionComponent* sc);
-static void updateSessionTransition(const SessionComponent* session, float progress);
+static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, PlayerComponent* p, int playerIndex, Entity session);
+static void joinSessionRenderGroup(SessionComponent* session);
 static void checkCoinsPickupForRunner(PlayerComponent* player, Entity e, RunnerComponent* rc, SessionComponent* sc);
+// fixed timestep helpers (see param::SimulationTickRate)
+static void restoreTickPositions(const SessionComponent* sc);
+static void beginTick(const SessionComponent* sc);
+static void interpolateTickPositions(const SessionComponent* sc, float alpha);
+
+// transform of e, for RunnerRules
+static RunnerRules::Box box(Entity e) {
+	const TransformationComponent* tc = TRANSFORM(e);
+	return RunnerRules::Box(tc->position, tc->size, tc->rotation);
+}
 
 class GameScene : public StateHandler<Scene::Enum> {
 	RecursiveRunnerGame* game;
 	Entity pauseButton;
 	Entity session;
 	Entity transition;
+	// fixed timestep: time not simulated yet
+	float accumulator;
+	bool touchingLastStep;
+	// kills broad phase
+	RunnerRules::KillSweep killSweep;
+	// platform switches
+	RunnerRules::SwitchIndex switchIndex;
 
 public:
 		GameScene(RecursiveRunnerGame* game) : StateHandler<Scene::Enum>("game") {
 			this->game = game;
+			accumulator = 0;
+			touchingLastStep = false;
 		}
 
 		void setup(AssetAPI*) override {
@@ -88,12 +110,16 @@ public:
 			ADSR(transition)->active = true;
 
 			if (theSessionSystem.entityCount() == 0) {
-				RecursiveRunnerGame::startGame(game->level, true);
+				session = game->startGame(game->level, true);
 				MUSIC(transition)->fadeOut = 2;
 				MUSIC(transition)->volume = 1;
 				MUSIC(transition)->music = theMusicSystem.loadMusicFile("sounds/jeu.ogg");
 				ADSR(transition)->value = ADSR(transition)->idleValue;
 				ADSR(transition)->activationTime = 0;
+			} else {
+				SessionComponent* restored = SESSION(theSessionSystem.RetrieveAllEntityWithComponent().front());
+				if (restored->renderGroup.empty())
+					joinSessionRenderGroup(restored);
 			}
 			if (theMusicSystem.isMuted()) {
 				MUSIC(transition)->control = MusicControl::Stop;
@@ -107,10 +133,10 @@ public:
 		}
 
 		bool updatePreEnter(Scene::Enum, float) override {
-			const SessionComponent* session = SESSION(theSessionSystem.RetrieveAllEntityWithComponent().front());
+			SessionComponent* session = SESSION(theSessionSystem.RetrieveAllEntityWithComponent().front());
 
 			float progress = ADSR(transition)->value;
-			updateSessionTransition(session, progress);
+			session->renderGroup.setAlpha(progress);
 			RENDERING(pauseButton)->color.a = progress;
 			PLAYER(session->players[0])->ready = true;
 
@@ -120,15 +146,41 @@ public:
 		void onEnter(Scene::Enum from) override {
 			session = theSessionSystem.RetrieveAllEntityWithComponent().front();
 			SessionComponent* sc = SESSION(session);
+			// platforms runners can land on (PlatformerSystem doesn't save them)
+			thePlatformerSystem.clearPlatforms();
+			{
+				// ground spans the level, and half a screen further on both sides
+				const LevelLayout layout = RecursiveRunnerGame::levelLayout(sc->levelSize);
+				TRANSFORM(game->ground)->size.x = layout.width() + PlacementHelper::ScreenSize.x;
+				TRANSFORM(game->ground)->position.x = layout.left + layout.width() * 0.5;
+				// camera and route (same range: the route scrolls with the camera) span the level too.
+				// Computed from the layout: restored sessions don't go through startGame
+				RANGE_FOLLOWER(game->cameraEntity)->range = RANGE_FOLLOWER(game->route)->range =
+					Interval<float>(layout.left + PlacementHelper::ScreenSize.x * 0.5, layout.right() - PlacementHelper::ScreenSize.x * 0.5);
+			}
+			thePlatformerSystem.addPlatform(game->ground, true);
+			for (unsigned i=0; i<sc->platforms.size(); i++) {
+				thePlatformerSystem.addPlatform(sc->platforms[i].platform, sc->platforms[i].active);
+			}
+			// switches don't move
+			switchIndex.clear();
+			for (unsigned i=0; i<sc->platforms.size(); i++) {
+				for (unsigned l=0; l<2; l++) {
+					switchIndex.add(box(sc->platforms[i].switches[l].entity));
+				}
+			}
+			switchIndex.build();
 			// only do this on first enter (ie: not when unpausing)
 			if (from != Scene::Pause) {
 				for (unsigned i=0; i<sc->numPlayers; i++) {
 					assert (sc->numPlayers == 1);
-					Entity r = addRunnerToPlayer(game, sc->players[i], PLAYER(sc->players[i]), i, sc);
+					Entity r = addRunnerToPlayer(game, sc->players[i], PLAYER(sc->players[i]), i, session);
 					sc->runners.push_back(r);
 					sc->currentRunner = r;
 				}
 				game->setupCamera(CameraMode::Single);
+				accumulator = 0;
+				touchingLastStep = false;
 
 				game->successManager.gameStart(from == Scene::Tutorial);
 			}
@@ -150,12 +202,67 @@ public:
 			}
 			RENDERING(pauseButton)->color = BUTTON(pauseButton)->mouseOver ? Color(HASH("gray", 0xd8a86c30)) : Color();
 
-			// Manage piano's volume depending on the distance from the current runner to the piano
+			// Manage piano's volume depending on the distance from the current runner to the piano,
+			// relative to the level width (sessions saved before level sizes existed use the default one)
+			const int levelSize = sc->levelSize ? sc->levelSize : param::LevelSize;
 			double distanceAbs = glm::abs(TRANSFORM(sc->currentRunner)->position.x -
-			TRANSFORM(game->pianist)->position.x) / (PlacementHelper::ScreenSize.x * param::LevelSize);
-			MUSIC(transition)->volume = 0.2 + 0.8 * (1 - distanceAbs);
+			TRANSFORM(game->pianist)->position.x) / (PlacementHelper::ScreenSize.x * levelSize);
+			// runners start out of the level, a bit further than its width
+			MUSIC(transition)->volume = 0.2 + 0.8 * glm::max(0.0, 1 - distanceAbs);
+
+			// coins and links around the camera
+			if (sc->streamed) {
+				game->streamLevel(sc, TRANSFORM(game->cameraEntity)->position.x);
+			}
+
+			Scene::Enum next = Scene::Game;
+			if (param::SimulationTickRate > 0) {
+				// Fixed timestep: simulate from the last tick positions, then display interpolated ones
+				const float tick = 1.0f / param::SimulationTickRate;
+				restoreTickPositions(sc);
+				accumulator += dt;
+				while (accumulator >= tick && next == Scene::Game) {
+					accumulator -= tick;
+					beginTick(sc);
+					next = simulate(sc, tick);
+				}
+				interpolateTickPositions(sc, accumulator / tick);
+			} else {
+				next = simulate(sc, dt);
+			}
+			if (next != Scene::Game)
+				return next;
+
+			// Show the score(s)
+			for (unsigned i=0; i<sc->players.size(); i++) {
+				TEXT(game->scoreText)->text = ObjectSerializer<int>::object2string(PLAYER(sc->players[i])->points);
+			}
+
+			theCameraTargetSystem.Update(dt);
+
+			return Scene::Game;
+		}
+
+		// One simulation step: runners, inputs, collisions, coins and platforms
+		Scene::Enum simulate(SessionComponent* sc, float dt) {
 			int runnerIdx = RUNNER(sc->currentRunner)->index;
 
+			// Input state. Several steps may run during a frame, so previous state is tracked here
+#if SAC_BENCHMARK_MODE
+			static bool simulateDown = false;
+			static float stateDuration = 0;
+			stateDuration -= dt;
+			if (stateDuration < 0) {
+				simulateDown = !simulateDown;
+				stateDuration = simulateDown ? Random::Float(0, 0.5) : Random::Float(0, 3);
+			}
+			const bool touching = simulateDown;
+#else
+			const bool touching = theTouchInputManager.isTouched(0);
+#endif
+			const bool wasTouching = touchingLastStep;
+			touchingLastStep = touching;
+
 			// Manage player's current runner
 			for (unsigned i=0; i<sc->numPlayers; i++) {
 				CAM_TARGET(sc->currentRunner)->enabled = true;
@@ -169,7 +276,10 @@ public:
 					CAM_TARGET(sc->currentRunner)->enabled = false;
 					game->successManager.oneMoreRunner(RUNNER(sc->currentRunner)->totalCoinsEarned);
 
-					if (PLAYER(sc->players[i])->runnersCount == param::runner) {
+					const bool over = (sc->level == Level::Endless) ?
+						(RUNNER(sc->currentRunner)->totalCoinsEarned == 0) :
+						(PLAYER(sc->players[i])->runnersCount == param::runner);
+					if (over) {
 						// Game is finished, show either Rate Menu or Main Menu
 						LOGW("Apprater is disabled yet!");
 						if (0 && game->gameThreadContext->communicationAPI->mustShowRateDialog()) {
@@ -180,7 +290,7 @@ public:
 					} else {
 						LOGI("Create runner");
 						// add a new runner
-						sc->currentRunner = addRunnerToPlayer(game, sc->players[i], PLAYER(sc->players[i]), i, sc);
+						sc->currentRunner = addRunnerToPlayer(game, sc->players[i], PLAYER(sc->players[i]), i, session);
 						sc->runners.push_back(sc->currentRunner);
 
 					}
@@ -191,47 +301,19 @@ public:
 						RENDERING(game->statman)->texture = theRenderingSystem.loadTextureFile("statman_droite");
 					}
 				}
-				if (!game->ignoreClick && sc->userInputEnabled) {
+				if (!game->ignoreClick && sc->userInputEnabled && touching) {
 					// Input (jump) handling
-					for (int j=0; j<1; j++) {
-#if SAC_BENCHMARK_MODE
-					static bool simulateDown = false, simulateWasDown = false;
-					static float stateDuration = 0;
-						stateDuration -= dt;
-						simulateWasDown = simulateDown;
-						if (stateDuration < 0) {
-							simulateDown = !simulateDown;
-							stateDuration = simulateDown ? Random::Float(0, 0.5) : Random::Float(0, 3);
-						}
-						if (simulateDown) {
-#else
-						if (theTouchInputManager.isTouched(j)) {
-#endif
-							if (sc->numPlayers == 2) {
-								const glm::vec2& ppp = theTouchInputManager.getTouchLastPosition(j);
-								if (i == 0 && ppp.y < 0)
-									continue;
-								if (i == 1 && ppp.y > 0)
-									continue;
-							}
-							PhysicsComponent* pc = PHYSICS(sc->currentRunner);
-							RunnerComponent* rc = RUNNER(sc->currentRunner);
+					bool forThisPlayer = true;
+					if (sc->numPlayers == 2) {
+						const glm::vec2& ppp = theTouchInputManager.getTouchLastPosition(0);
+						forThisPlayer = (i == 0) ? (ppp.y >= 0) : (ppp.y <= 0);
+					}
+					if (forThisPlayer) {
+						PhysicsComponent* pc = PHYSICS(sc->currentRunner);
+						RunnerComponent* rc = RUNNER(sc->currentRunner);
 
-#if SAC_BENCHMARK_MODE
-							if (! simulateWasDown) {
-#else
-							if (! theTouchInputManager.wasTouched(j)) {
-#endif
-								if (rc->jumpingSince <= 0 && pc->linearVelocity.y == 0) {
-									rc->jumpTimes.push_back(rc->elapsed);
-									rc->jumpDurations.push_back(dt);
-								}
-							} else if (!rc->jumpTimes.empty()) {
-								float& d = *(rc->jumpDurations.rbegin());
-								d = glm::min(d + dt, RunnerSystem::MaxJumpDuration);
-							}
-							break;
-						}
+						RunnerRules::jumpInput(sc->jumps, rc->jumpTrack, wasTouching,
+							rc->elapsed, rc->jumpingSince, pc->linearVelocity.y, dt);
 					}
 				}
 
@@ -241,44 +323,25 @@ public:
 
 			// Manage runner-runner collisions
 			{
-				std::vector<TransformationComponent*> activesColl;
-				std::vector<int> direction;
-
-				for (unsigned i=0; i<sc->numPlayers; i++) {
-					for (unsigned j=0; j<sc->runners.size(); j++) {
-						const Entity r = sc->runners[j];
-						const RunnerComponent* rc = RUNNER(r);
-						if (rc->ghost)
-							continue;
-						activesColl.push_back(TRANSFORM(rc->collisionZone));
-						direction.push_back(rc->speed > 0 ? 1 : -1);
-					}
+				killSweep.clear();
+				for (unsigned j=0; j<sc->runners.size(); j++) {
+					const RunnerComponent* rc = RUNNER(sc->runners[j]);
+					if (!rc->killed)
+						killSweep.add(j, box(rc->collisionZone), rc->ghost, rc->elapsed, rc->speed > 0);
 				}
-				const unsigned count = activesColl.size();
-				for (unsigned i=0; i<sc->numPlayers; i++) {
-					for (unsigned j=0; j<sc->runners.size(); j++) {
-						Entity ghost = sc->runners[j];
-						RunnerComponent* rc = RUNNER(ghost);
-						if (!rc->ghost || rc->killed)
-							continue;
-						TransformationComponent* ghostColl = TRANSFORM(rc->collisionZone);
-						for (unsigned k=0; k<count; k++) {
-							// we can only hit guys with opposite direction
-							if (rc->speed * direction[k] > 0)
-								continue;
-							if (rc->elapsed < 0.25)
-								continue;
-							if (IntersectionUtil::rectangleRectangle(ghostColl, activesColl[k])) {
-								rc->killed = true;
-								sc->stats.runner[runnerIdx].killed ++;
-								sc->runners.erase(sc->runners.begin() + j);
-								j--;
-
-								game->successManager.oneLessRunner();
-								break;
-							}
-						}
-					}
+
+				bool killed = false;
+				killSweep.find([this, sc, runnerIdx, &killed] (int g) -> void {
+					RUNNER(sc->runners[g])->killed = true;
+					sc->stats.runner[runnerIdx].killed ++;
+					game->successManager.oneLessRunner();
+					killed = true;
+				});
+				// killed runners are removed by RunnerSystem
+				if (killed) {
+					sc->runners.erase(std::remove_if(sc->runners.begin(), sc->runners.end(), [] (Entity r) -> bool {
+						return RUNNER(r)->killed;
+					}), sc->runners.end());
 				}
 			}
 
@@ -312,53 +375,35 @@ public:
 						sc->stats.runner[rc->index].maxOldness);
 
 					// check platform switch
-					const TransformationComponent* collisionZone = TRANSFORM(rc->collisionZone);
-					for (unsigned k=0; k<sc->platforms.size(); k++) {
-						for (unsigned l=0; l<2; l++) {
-							if (IntersectionUtil::rectangleRectangle(
-								collisionZone, TRANSFORM(sc->platforms[k].switches[l].entity))) {
-								sc->platforms[k].switches[l].owner = e;
-								if (!sc->platforms[k].switches[l].state) {
-									sc->platforms[k].switches[l].state = true;
-								}
-							}
-						}
-					}
+					switchIndex.touch(box(rc->collisionZone), [sc, e] (int k, int l) -> void {
+						sc->platforms[k].switches[l].owner = e;
+						sc->platforms[k].switches[l].state = true;
+					});
 				}
 			}
 
 			// handle platforms
 			{
-				const auto& platformers = thePlatformerSystem.RetrieveAllEntityWithComponent();
 				for (unsigned i=0; i<sc->platforms.size(); i++) {
 					Platform& pt = sc->platforms[i];
-					bool active = pt.switches[1].state & pt.switches[1].state & (
-						pt.switches[1].owner == pt.switches[0].owner);
+					const bool active = RunnerRules::switchesOn(pt);
 					if (active != pt.active) {
 						pt.active = active;
 						std::cout << "platform #" << i << " is now : " << active << std::endl;
 						if (active) {
-							RENDERING(pt.platform)->texture = HASH("link", 0x0);
+							RENDERING(pt.platform)->texture = HASH("link", 0xcacec0a0);
 						} else {
 							RENDERING(pt.platform)->texture = InvalidTextureRef;
 						}
 
-						for (auto pl: platformers) {
-							PLATFORMER(pl)->platforms[pt.platform] = active;
-						}
+						thePlatformerSystem.setPlatformActive(pt.platform, active);
 					}
 				}
 			}
 
-			// Show the score(s)
-			for (unsigned i=0; i<sc->players.size(); i++) {
-				TEXT(game->scoreText)->text = ObjectSerializer<int>::object2string(PLAYER(sc->players[i])->points);
-			}
-
 			thePlatformerSystem.Update(dt);
 			thePlayerSystem.Update(dt);
 			theRunnerSystem.Update(dt);
-			theCameraTargetSystem.Update(dt);
 
 			return Scene::Game;
 		}
@@ -384,10 +429,8 @@ public:
 			if (to == Scene::Pause) {
 				return true;
 			}
-			const SessionComponent* session = SESSION(theSessionSystem.RetrieveAllEntityWithComponent().front());
-
 			float progress = ADSR(transition)->value;
-			updateSessionTransition(session, progress);
+			SESSION(session)->renderGroup.setAlpha(progress);
 			RENDERING(pauseButton)->color.a = progress;
 
 			return progress <= ADSR(transition)->idleValue;
@@ -404,30 +447,66 @@ namespace Scene {
 	}
 }
 
-static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, PlayerComponent* p, int playerIndex, SessionComponent* sc) {
+static void restoreTickPositions(const SessionComponent* sc) {
+	for (unsigned i=0; i<sc->runners.size(); i++) {
+		const RunnerComponent* rc = RUNNER(sc->runners[i]);
+		TransformationComponent* tc = TRANSFORM(sc->runners[i]);
+		tc->position = rc->tickPosition;
+		// AnchorSystem placed the zone on the interpolated position
+		theRunnerSystem.syncCollisionZone(rc, tc);
+	}
+}
+
+static void beginTick(const SessionComponent* sc) {
+	for (unsigned i=0; i<sc->runners.size(); i++) {
+		RUNNER(sc->runners[i])->previousTickPosition = TRANSFORM(sc->runners[i])->position;
+	}
+}
+
+static void interpolateTickPositions(const SessionComponent* sc, float alpha) {
+	for (unsigned i=0; i<sc->runners.size(); i++) {
+		RunnerComponent* rc = RUNNER(sc->runners[i]);
+		TransformationComponent* tc = TRANSFORM(sc->runners[i]);
+		rc->tickPosition = tc->position;
+		// no interpolation when runner is moved back to its start point
+		if (glm::abs(rc->tickPosition.x - rc->previousTickPosition.x) < PlacementHelper::ScreenSize.x) {
+			tc->position = glm::mix(rc->previousTickPosition, rc->tickPosition, alpha);
+		}
+	}
+}
+
+static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, PlayerComponent* p, int playerIndex, Entity session) {
+	SessionComponent* sc = SESSION(session);
 	int direction = ((p->runnersCount + playerIndex) % 2) ? -1 : 1;
-	Entity e = theEntityManager.CreateEntityFromTemplate("ingame/runner");
+	Entity e = theRunnerSystem.spawnRunner();
 	TRANSFORM(e)->size *= .68f;
-	TRANSFORM(e)->z += 0.01 * p->runnersCount;
+	// newer runners are drawn on top, bounded for endless sessions (~0.01 per runner at first)
+	TRANSFORM(e)->z += 0.1 * (1 - 1 / (1 + 0.1 * p->runnersCount));
+	const LevelLayout layout = RecursiveRunnerGame::levelLayout(sc->levelSize);
+	const float left = layout.left - TRANSFORM(e)->size.x * 0.5, right = layout.right() + TRANSFORM(e)->size.x * 0.5;
 	TRANSFORM(e)->position = AnchorSystem::adjustPositionWithCardinal(
-		glm::vec2(direction * -(param::LevelSize * PlacementHelper::ScreenSize.x + TRANSFORM(e)->size.x) * 0.5, game->baseLine),
+		glm::vec2((direction > 0) ? left : right, game->baseLine),
 		TRANSFORM(e)->size,
 		Cardinal::S);
 	RUNNER(e)->startPoint = TRANSFORM(e)->position;
-	RUNNER(e)->endPoint = glm::vec2(direction * (param::LevelSize * PlacementHelper::ScreenSize.x + TRANSFORM(e)->size.x) * 0.5, 0);
+	RUNNER(e)->endPoint = glm::vec2((direction > 0) ? right : left, 0);
 	RUNNER(e)->speed = direction * (param::speedConst + param::speedCoeff * p->runnersCount);
 	RUNNER(e)->startTime = 0;//MathUtil::RandomFloatInRange(1,3);
 	RUNNER(e)->playerOwner = player;
+	RUNNER(e)->session = session;
+	RUNNER(e)->jumpTrack = sc->jumps.createTrack();
+	RUNNER(e)->previousTickPosition = RUNNER(e)->tickPosition = TRANSFORM(e)->position;
 
 	PLATFORMER(e)->offset = glm::vec2(0, TRANSFORM(e)->size.y * -0.5);
-	PLATFORMER(e)->platforms.insert(std::make_pair(game->ground, true));
-	for (unsigned i=0; i<sc->platforms.size(); i++) {
-		PLATFORMER(e)->platforms.insert(std::make_pair(sc->platforms[i].platform, sc->platforms[i].active));
-	}
 
-	int idx = (int)glm::linearRand(0.0f, (float)p->colors.size());
+	if (p->colors.empty()) {
+		RecursiveRunnerGame::addRunnerColors(p->colors, p->runnersCount / param::runner);
+	}
+	int idx = sc->random.Int(0, p->colors.size() - 1);
 	RUNNER(e)->color = p->colors[idx];
 	p->colors.erase(p->colors.begin() + idx);
+	sc->stats.grow(p->runnersCount + 1);
+	sc->stats.color[p->runnersCount] = RUNNER(e)->color;
 
 	CAM_TARGET(e)->camera = game->cameraEntity;
 	CAM_TARGET(e)->maxCameraSpeed = direction * RUNNER(e)->speed;
@@ -437,10 +516,8 @@ static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, Player
 	else
 		RENDERING(e)->flags &= ~(RenderingFlags::MirrorHorizontal);
 
-	Entity collisionZone = theEntityManager.CreateEntityFromTemplate("ingame/collision_zone");
-	ANCHOR(collisionZone)->parent = e;
-	RUNNER(e)->collisionZone = collisionZone;
 	RUNNER(e)->index = p->runnersCount;
+	sc->renderGroup.add(e);
 
 	p->runnersCount++;
 	LOGI("Add runner " << e << " at pos : " << TRANSFORM(e)->position << "}, speed: " <<
@@ -449,79 +526,75 @@ static Entity addRunnerToPlayer(RecursiveRunnerGame* game, Entity player, Player
 	return e;
 }
 
-static void updateSessionTransition(const SessionComponent* session, float progress) {
+static void joinSessionRenderGroup(SessionComponent* session) {
+	RenderGroup& group = session->renderGroup;
 	for (unsigned i=0; i<session->coins.size(); i++) {
-		RENDERING(session->coins[i])->color.a = progress;
+		if (session->coins[i])
+			group.add(session->coins[i]);
 	}
 	for (unsigned i=0; i<session->links.size(); i++) {
-		RENDERING(session->links[i])->color.a = progress;
+		if (session->links[i])
+			group.add(session->links[i]);
+	}
+	for (unsigned i=0; i<session->platforms.size(); i++) {
+		group.add(session->platforms[i].platform);
+		group.add(session->platforms[i].switches[0].entity);
+		group.add(session->platforms[i].switches[1].entity);
+	}
+	for (unsigned i=0; i<session->runners.size(); i++) {
+		group.add(session->runners[i]);
 	}
-	theRunnerSystem.forEachEntityDo([progress] (Entity e) -> void {
-		RENDERING(e)->color.a = progress;
-	});
 }
 
 static void checkCoinsPickupForRunner(PlayerComponent* player, Entity e, RunnerComponent* rc, SessionComponent* sc) {
-	const auto* collisionZone = TRANSFORM(rc->collisionZone);
-	const int end = sc->coins.size();
-	Entity prev = 0;
-
-	for(int i=0; i<end; i++) {
-		int idx = (rc->speed > 0) ? i : (end - i - 1);
-		Entity coin = sc->coins[idx];
-		/* lookup if runner has already picked up that coin */
-		if (std::find(rc->coins.begin(), rc->coins.end(), coin) == rc->coins.end()) {
-			/* if not, test for intersection */
-			const TransformationComponent* tCoin = TRANSFORM(coin);
-			if (IntersectionUtil::rectangleRectangle(
-				collisionZone->position, collisionZone->size, collisionZone->rotation,
-				tCoin->position, tCoin->size * glm::vec2(0.5, 0.6) /* why ? */, tCoin->rotation)) {
-				/* if coin isn't the 1st one picked, check for consecutive pickup bonus */
-				if (!rc->coins.empty()) {
-				 int linkIdx = rc->speed > 0 ? idx : idx + 1;
-					if (rc->coins.back() == prev) {
-						rc->coinSequenceBonus++;
-						sc->stats.runner[rc->index].maxBonus = glm::max(sc->stats.runner[rc->index].maxBonus, rc->coinSequenceBonus);
-						if (!rc->ghost) {
-							if (rc->speed > 0) {
-								for (int j=1; j<rc->coinSequenceBonus; j++) {
-									float t = 1 * ((rc->coinSequenceBonus - (j - 1.0)) / (float)rc->coinSequenceBonus);
-									PARTICULE(sc->sparkling[linkIdx - j + 1])->duration += t;
-								}
-							} else {
-								for (int j=1; j<rc->coinSequenceBonus; j++) {
-									PARTICULE(sc->sparkling[linkIdx + j - 1])->duration +=
-										1 * ((rc->coinSequenceBonus - (j - 1.0)) / (float)rc->coinSequenceBonus);
-								}
-							}
-						}
-					} else {
-						rc->coinSequenceBonus = 1;
-					}
-				}
-				rc->coins.push_back(coin);
-				int gain = 10 * pow(2.0f, rc->oldNessBonus) * rc->coinSequenceBonus;
-				player->points += gain;
+	const int end = sc->coinPositions.size();
+	if (end == 0)
+		return;
+
+	/* picked coins bitset isn't saved, rebuild it if needed */
+	if (rc->pickedCoins.size() != (unsigned)(end + 31) / 32) {
+		CoinSweep::reset(rc->pickedCoins, end);
+		for (unsigned i=0; i<rc->coins.size(); i++) {
+			if (rc->coins[i] < end)
+				CoinSweep::pick(rc->pickedCoins, rc->coins[i]);
+		}
+	}
 
-				/* update statistics */
-				{
-					sc->stats.runner[rc->index].pointScored += gain;
+	/* Coins entities may not exist (streamed levels), so positions are used */
+	RunnerRules::pickCoins(*rc, rc->speed > 0, box(rc->collisionZone), sc->coinPositions, sc->coinSize,
+		sc->stats.runner[rc->index].maxBonus, [player, e, rc, sc] (int idx, int gain) -> void {
+		/* coin extends a sequence: update sparkling links */
+		if (rc->coinSequenceBonus > 1 && !rc->ghost) {
+			const int linkIdx = rc->speed > 0 ? idx : idx + 1;
+			for (int j=1; j<rc->coinSequenceBonus; j++) {
+				const int k = (rc->speed > 0) ? (linkIdx - j + 1) : (linkIdx + j - 1);
+				// links far from the camera may be released
+				if (sc->sparkling[k]) {
+					PARTICULE(sc->sparkling[k])->duration +=
+						1 * ((rc->coinSequenceBonus - (j - 1.0)) / (float)rc->coinSequenceBonus);
 				}
+			}
+		}
+		player->points += gain;
 
-				//coins++ only for player, not his ghosts
-				if (sc->currentRunner == e) {
-					player->coins++;
-					sc->stats.runner[rc->index].coinsCollected = sc->stats.runner[rc->index].coinsCollected + 1;
-				}
+		/* update statistics */
+		{
+			sc->stats.runner[rc->index].pointScored += gain;
+		}
 
-				/* reset lifetime of gain entity */
-				AUTO_DESTROY(sc->gains[idx])->params.lifetime.freq.accum = 0;
-				RENDERING(sc->gains[idx])->show = 1;
-				RENDERING(sc->gains[idx])->color = rc->color;
-			}
+		//coins++ only for player, not his ghosts
+		if (sc->currentRunner == e) {
+			player->coins++;
+			sc->stats.runner[rc->index].coinsCollected = sc->stats.runner[rc->index].coinsCollected + 1;
 		}
-		prev = coin;
-	}
+
+		/* reset lifetime of gain entity */
+		if (sc->gains[idx]) {
+			AUTO_DESTROY(sc->gains[idx])->params.lifetime.freq.accum = 0;
+			RENDERING(sc->gains[idx])->show = 1;
+			RENDERING(sc->gains[idx])->color = rc->color;
+		}
+	});
 }
 
 #define TUTORIAL_COMPILE_GUARD
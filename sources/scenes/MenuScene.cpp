@@ -40,7 +40,6 @@
 
 #include "api/LocalizeAPI.h"
 #include "api/StorageAPI.h"
-#include "util/ScoreStorageProxy.h"
 
 #include "../RecursiveRunnerGame.h"
 #include "../Parameters.h"
@@ -58,6 +57,18 @@ static void startMenuMusic(Entity title) {
     MUSIC(title)->control = MusicControl::Play;
 }
 
+// untranslated name (assets/strings key)
+static const char* levelName(Level::Enum level) {
+    switch (level) {
+        case Level::Level1: return "Level 1";
+        case Level::Level2: return "Level 2";
+        case Level::Level3: return "Level 3";
+        case Level::Long: return "Long";
+        case Level::Endless: return "Endless";
+    }
+    return "";
+}
+
 namespace Button {
     enum Enum {
         Help = 0,
@@ -70,6 +81,8 @@ namespace Button {
 class MenuScene : public StateHandler<Scene::Enum> {
     RecursiveRunnerGame* game;
     Entity titleGroup, title, subtitle, subtitleText;
+    // tap to cycle through levels
+    Entity levelText;
     Entity buttons[Button::Count];
     std::mutex m;
     int weeklyRank;
@@ -98,6 +111,9 @@ class MenuScene : public StateHandler<Scene::Enum> {
             TEXT(subtitleText)->text = game->gameThreadContext->localizeAPI->text("Tap screen to start");
             TEXT(subtitleText)->charHeight *= 1.5;
 
+            levelText = theEntityManager.CreateEntityFromTemplate("menu/level_text");
+            TEXT(levelText)->text = game->gameThreadContext->localizeAPI->text(levelName(game->level));
+
             buttons[Button::Help] = theEntityManager.CreateEntity(HASH("menu/help_button", 0xf0532382),
                 EntityType::Persistent, theEntityManager.entityTemplateLibrary.load("menu/button"));
             ANCHOR(buttons[Button::Help])->parent = game->muteBtn;
@@ -134,22 +150,19 @@ class MenuScene : public StateHandler<Scene::Enum> {
                 + " " + game->gameThreadContext->localizeAPI->text("points") + " - " + game->gameThreadContext->localizeAPI->text("tap screen to restart");
 
                 //save the score in DB
-                ScoreStorageProxy ssp;
-                ssp.setValue("points", ObjectSerializer<int>::object2string(PLAYER(players.front())->points), true); // ask to create a new score
-                ssp.setValue("coins", ObjectSerializer<int>::object2string(PLAYER(players.front())->coins), false);
-                ssp.setValue("name", "rzehtrtyBg", false);
-                game->gameThreadContext->storageAPI->saveEntries(&ssp);
-
-                game->updateBestScore();
+                const unsigned rank = game->saveScore(PLAYER(players.front())->points, PLAYER(players.front())->coins);
+                if (rank < game->topScores.getCapacity()) {
+                    LOGI("Score rank: #" << (rank + 1));
+                }
 
                 #if SAC_USE_PROPRIETARY_PLUGINS
                     // Submit score to generic leaderboard
-                    game->gameThreadContext->gameCenterAPI->submitScore(0, ssp.getValue("points"));
+                    game->gameThreadContext->gameCenterAPI->submitScore(0, ObjectSerializer<int>::object2string(PLAYER(players.front())->points));
                     if (game->level == Level::Level2) {
                         // Submit score to daily leaderboard
                         // time_t t = time(0);
                         // struct tm * timeinfo = localtime (&t);
-                        game->gameThreadContext->gameCenterAPI->submitScore(1 /*+ tm->tm_mday*/, ssp.getValue("points"));
+                        game->gameThreadContext->gameCenterAPI->submitScore(1 /*+ tm->tm_mday*/, ObjectSerializer<int>::object2string(PLAYER(players.front())->points));
                         // retrieve weekly rank
                         game->gameThreadContext->gameCenterAPI->getWeeklyRank(1 /*+ tm->tm_mday*/, [this] (int rank) -> void {
                                 std::unique_lock<std::mutex> l(m);
@@ -209,6 +222,8 @@ class MenuScene : public StateHandler<Scene::Enum> {
                 BUTTON(buttons[i])->enabled = true;
                 RENDERING(buttons[i])->color.a = 1;
             }
+            BUTTON(levelText)->enabled = true;
+            TEXT(levelText)->text = game->gameThreadContext->localizeAPI->text(levelName(game->level));
             BUTTON(game->muteBtn)->enabled = true;
             RENDERING(game->muteBtn)->color.a = 1;
             #if SAC_USE_PROPRIETARY_PLUGINS
@@ -270,11 +285,18 @@ void backgroundUpdate(float) {
                     game->ignoreClick = true;
                    return Scene::Stats;
                 }
+                if (BUTTON(levelText)->clicked) {
+                    game->level = (Level::Enum)((game->level + 1) % (Level::Endless + 1));
+                    TEXT(levelText)->text = game->gameThreadContext->localizeAPI->text(levelName(game->level));
+                    LOGI("Selected level: " << levelName(game->level));
+                    game->ignoreClick = true;
+                }
 
                 for (int i=0; i<Button::Count; i++) {
                     game->ignoreClick |= BUTTON(buttons[i])->mouseOver;
                 }
                 game->ignoreClick |= BUTTON(game->statman)->mouseOver;
+                game->ignoreClick |= BUTTON(levelText)->mouseOver;
             }
             RENDERING(buttons[Button::Help])->color = BUTTON(buttons[Button::Help])->mouseOver ? Color(HASH("gray", 0xd8a86c30)) : Color();
             RENDERING(buttons[Button::About])->color = BUTTON(buttons[Button::About])->mouseOver ? Color(HASH("gray", 0xd8a86c30)) : Color();
@@ -289,8 +311,10 @@ void backgroundUpdate(float) {
 #if SAC_EMSCRIPTEN
                     return Scene::Game;
 #else
-                    int current = ObjectSerializer<int>::string2object(game->gameThreadContext->storageAPI->getOption("gameCount"));
-                    game->gameThreadContext->storageAPI->setOption("gameCount", ObjectSerializer<int>::object2string(current + 1), "0");
+                    const int current = game->gameCount++;
+                    game->persistence.push([current] (StorageAPI* storage) -> void {
+                        storage->setOption("gameCount", ObjectSerializer<int>::object2string(current + 1), "0");
+                    });
 
                     if (current == 0) {
                         return Scene::Tutorial;
@@ -316,6 +340,7 @@ void backgroundUpdate(float) {
             for (int i=0; i<(int)Button::Count; i++) {
                 BUTTON(buttons[i])->enabled = false;
             }
+            BUTTON(levelText)->enabled = false;
             if(nextScene == Scene::About || nextScene == Scene::Stats)
                 BUTTON(game->muteBtn)->enabled = false;
 
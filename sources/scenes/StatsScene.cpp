@@ -73,6 +73,9 @@ namespace Text {
     };
 }
 
+// the chart needs readable bars
+static const unsigned MaxChartedRunners = 20;
+
 class StatsScene : public StateHandler<Scene::Enum> {
     RecursiveRunnerGame* game;
 
@@ -133,7 +136,7 @@ public:
 
         char tmp[64];
         /* score bar */
-        for (int i=0; i<10; i++) {
+        for (unsigned i=0; i<statisticsToDisplay->runner.size(); i++) {
             const T value = *((T*) ((uint8_t*)&statisticsToDisplay->runner[i] + offset));
             if (value < minValue) continue;
 
@@ -170,18 +173,33 @@ public:
 #endif
     int runnerPointMax(const Statistics* s) {
         int m = 0;
-        for (int i=0; i<10; i++) m = glm::max(m, s->runner[i].pointScored);
+        for (const auto& r : s->runner) m = glm::max(m, r.pointScored);
         return m;
     }
     int runnerPointMin(const Statistics* s) {
+        if (s->runner.empty()) return 0;
         int m = INT_MAX;
-        for (int i=0; i<10; i++) m = glm::min(m, s->runner[i].pointScored);
+        for (const auto& r : s->runner) m = glm::min(m, r.pointScored);
         return m;
     }
     int runnerPointAverage(const Statistics* s) {
+        if (s->runner.empty()) return 0;
         int m = 0;
-        for (int i=0; i<10; i++) m += s->runner[i].pointScored;
-        return m * 0.1;
+        for (const auto& r : s->runner) m += r.pointScored;
+        return m / (int)s->runner.size();
+    }
+    // runners missing from a (shorter) game scored nothing
+    int runnerPoints(const Statistics* s, unsigned i) {
+        return (i < s->runner.size()) ? s->runner[i].pointScored : 0;
+    }
+    // bars of the chart: one per runner of the longest of the 3 games, up to MaxChartedRunners
+    // (endless games have no runner limit, only their first runners are charted)
+    unsigned chartedRunners() {
+        unsigned count = 0;
+        for (int j=0; j<3; j++) {
+            count = glm::max(count, (unsigned)game->statistics.s[j]->runner.size());
+        }
+        return glm::min(count, MaxChartedRunners);
     }
 
     float indexToScale(int idx) {
@@ -195,10 +213,11 @@ public:
     ///--------------------- ENTER SECTION ----------------------------------------//
     ///----------------------------------------------------------------------------//
     void onEnter(Scene::Enum) override {
+        const unsigned runnerCount = chartedRunners();
         int maxPointScored = 1;
-        for (int i=0; i<10; i++) {
+        for (unsigned i=0; i<runnerCount; i++) {
             for (int j=0; j<3; j++) {
-                    maxPointScored = glm::max(maxPointScored, game->statistics.s[j]->runner[i].pointScored);
+                    maxPointScored = glm::max(maxPointScored, runnerPoints(game->statistics.s[j], i));
             }
         }
         const glm::vec2& area = TRANSFORM(images[Image::Background])->size;
@@ -252,18 +271,18 @@ public:
 
         char tmp[64];
         float maxBarHeight = 2 * ANCHOR(texts[0])->position.y - spacing.y - maxScoreTextWidth;
-        float width = (area.x - spacing.x * 2.0f) / 10.0f;
+        float width = (area.x - spacing.x * 2.0f) / glm::max(runnerCount, 1u);
         glm::vec2 base = area * -0.5f + spacing + glm::vec2(width * 0.5f, 0.f);
-        for (int i=0; i<10; i++) {
+        for (unsigned i=0; i<runnerCount; i++) {
             int scores[3], sorted[3];
             for (int j=0; j<3; j++) {
-                scores[j] = game->statistics.s[j]->runner[i].pointScored;
+                scores[j] = runnerPoints(game->statistics.s[j], i);
                 sorted[j] = scores[j];
             }
             std::sort(sorted, sorted + 3, [] (int p, int q) -> bool { return p > q; });
 
             for (int j=0; j<3; j++) {
-                int value = game->statistics.s[j]->runner[i].pointScored;
+                int value = scores[j];
                 int index = j;
                 int indexSorted = std::find(sorted, sorted + 3, value) - sorted; // d € [0, 1, 2]
                 LOGE_IF(index < 0 || index > 2, "Uh");
@@ -310,7 +329,7 @@ public:
                 ANCHOR(t)->position.y = base.y - spacing.y * 0.3;
                 ANCHOR(t)->parent = images[Image::Background];
 
-                snprintf(tmp, 20, "%d", i+1);
+                snprintf(tmp, 20, "%u", i+1);
                 TEXT(t)->text = tmp;
                 TEXT(t)->positioning = 0.5;
                 texts.push_back(t);
@@ -320,6 +339,17 @@ public:
 
         TRANSFORM(images[Image::Runner])->position = TRANSFORM(images[Image::Background])->position + base - glm::vec2(spacing.x * 0.25f, 0.0f);
 
+        /* Every game played, rolled up ones included (see ScoreHistory) */
+        if (game->playedGames.games > 0) {
+            LocalizeAPI* localize = game->gameThreadContext->localizeAPI;
+            snprintf(tmp, 64, ": %d - ", game->playedGames.games);
+            std::string history = localize->text("Games played") + tmp;
+            snprintf(tmp, 64, ": %d ", game->playedGames.points / game->playedGames.games);
+            history += localize->text("Average") + tmp + localize->text("points");
+            createText(history.c_str(), glm::vec2(0, -area.y * 0.5 + spacing.y * 0.35), colors[2]);
+            TEXT(texts.back())->positioning = 0.5;
+        }
+
 
 #if 0
         /* Total points */
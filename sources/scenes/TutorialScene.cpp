@@ -162,7 +162,7 @@ struct TutorialStep : public StateHandler<Tutorial::Enum> {
         // restore anim
         for (unsigned i=0; i<sc->runners.size(); i++) {
             ANIMATION(sc->runners[i])->playbackSpeed = 1.1;
-            PHYSICS(sc->runners[i])->mass = 1;
+            // physics is restored by RunnerSystem
         }
         exitAction();
     }
@@ -241,12 +241,7 @@ public:
 
         // hack lights/links
         SessionComponent* session = SESSION(theSessionSystem.RetrieveAllEntityWithComponent().front());
-        std::for_each(session->coins.begin(), session->coins.end(), deleteEntityFunctor);
-        session->coins.clear();
-        std::for_each(session->links.begin(), session->links.end(), deleteEntityFunctor);
-        session->links.clear();
-        std::for_each(session->sparkling.begin(), session->sparkling.end(), deleteEntityFunctor);
-        session->sparkling.clear();
+        game->releaseCoinEntities(session, 0, session->coins.size());
 
         PlacementHelper::ScreenSize.x = 60;
         PlacementHelper::GimpSize.x = 3840;
@@ -275,7 +270,7 @@ public:
         std::vector<glm::vec2> coords;
         coords.resize(20);
         std::copy(c, &c[20], coords.begin());
-        RecursiveRunnerGame::createCoins(coords, session, true);
+        game->createCoins(coords, session);
 
         PlacementHelper::ScreenSize.x = 20;
         PlacementHelper::GimpSize.x = 1280;
@@ -310,8 +305,7 @@ public:
                 [session] () { return (TRANSFORM(session->currentRunner)->position.x >= -15); },
                 [session] () {
                     RunnerComponent* rc = RUNNER(session->currentRunner);
-                    rc->jumpTimes.push_back(rc->elapsed);
-                    rc->jumpDurations.push_back(0.06);
+                    session->jumps.push(rc->jumpTrack, rc->elapsed, 0.06);
                 },
                 "Tap the screen to jump"));
         // 4. ScorePoints
@@ -329,8 +323,7 @@ public:
                 [session] () { return (TRANSFORM(session->currentRunner)->position.x >= 0); },
                 [session] () {
                     RunnerComponent* rc = RUNNER(session->currentRunner);
-                    rc->jumpTimes.push_back(rc->elapsed);
-                    rc->jumpDurations.push_back(RunnerSystem::MaxJumpDuration);
+                    session->jumps.push(rc->jumpTrack, rc->elapsed, RunnerSystem::MaxJumpDuration);
                 },
                 "Do longer press to make higher jumps"));
         // 6. RunTilTheEdge
@@ -374,8 +367,7 @@ public:
                 },
                 [session] () {
                     RunnerComponent* rc = RUNNER(session->currentRunner);
-                    rc->jumpTimes.push_back(rc->elapsed);
-                    rc->jumpDurations.push_back(RunnerSystem::MaxJumpDuration * 0.8);
+                    session->jumps.push(rc->jumpTrack, rc->elapsed, RunnerSystem::MaxJumpDuration * 0.8);
                 },
                 "Avoid yourself, who will continue scoring points!"));
         // 10. BestScore
@@ -0,0 +1,76 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Little-endian integers and LEB128 varints, as stored in replay archives and the stats log
+namespace Bytes {
+    inline void writeVarint(std::vector<uint8_t>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(v);
+    }
+
+    // returns false if data ends before the varint does
+    inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (p >= end)
+                return false;
+            const uint8_t b = *p++;
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    inline void write16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xff;
+        p[1] = v >> 8;
+    }
+
+    inline void write32(uint8_t* p, uint32_t v) {
+        for (int i=0; i<4; i++) {
+            p[i] = (v >> (8 * i)) & 0xff;
+        }
+    }
+
+    inline uint16_t read16(const uint8_t* p) {
+        return p[0] | (p[1] << 8);
+    }
+
+    inline uint32_t read32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // FNV-1a: catches torn or corrupted writes, not tampering
+    inline uint32_t checksum(const uint8_t* p, unsigned size) {
+        uint32_t h = 2166136261u;
+        for (unsigned i=0; i<size; i++) {
+            h = (h ^ p[i]) * 16777619u;
+        }
+        return h;
+    }
+}
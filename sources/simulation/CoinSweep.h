@@ -0,0 +1,74 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/*
+ * Coins pickup helpers, shared by GameScene and SessionSimulator.
+ * Coins are sorted left to right, so a collision zone can only touch the few coins within
+ * its x extent: each runner keeps a cursor on the first of them, which follows the runner
+ * in the sorted array, and remembers picked coins in a bitset.
+ */
+namespace CoinSweep {
+    // half width of the bounding box of a rotated rectangle
+    inline float halfExtentX(const glm::vec2& size, float rotation) {
+        return 0.5f * (glm::abs(size.x * glm::cos(rotation)) + glm::abs(size.y * glm::sin(rotation)));
+    }
+
+    // Sets [first, last) to the coins whose x is in [minX, maxX]; x(i) must increase with i.
+    // cursor is the first coin of the previous window (-1 if unknown), it's updated.
+    template<typename CoinX>
+    void window(const CoinX& x, int count, float minX, float maxX, int& cursor, int& first, int& last) {
+        if (cursor < 0 || cursor > count) {
+            int lo = 0, hi = count;
+            while (lo < hi) {
+                const int mid = (lo + hi) / 2;
+                if (x(mid) < minX)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            cursor = lo;
+        } else {
+            // runners move a little at each step, so this is a step or two at most
+            while (cursor < count && x(cursor) < minX)
+                cursor++;
+            while (cursor > 0 && x(cursor - 1) >= minX)
+                cursor--;
+        }
+        first = last = cursor;
+        while (last < count && x(last) <= maxX)
+            last++;
+    }
+
+    // picked coins bitset
+    inline void reset(std::vector<uint32_t>& picked, int count) {
+        picked.assign((count + 31) / 32, 0);
+    }
+    inline bool isPicked(const std::vector<uint32_t>& picked, int coin) {
+        return (picked[coin >> 5] >> (coin & 31)) & 1;
+    }
+    inline void pick(std::vector<uint32_t>& picked, int coin) {
+        picked[coin >> 5] |= 1u << (coin & 31);
+    }
+}
@@ -0,0 +1,206 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "CollisionZone.h"
+
+#include "util/MurmurHash.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+#if !defined(_WIN32) && !SAC_EMSCRIPTEN
+#define COLLISION_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace RunnerCollision {
+    // Hand-tuned zones, in pixels of the 200x210 runner sprites: x, y, width, height, rotation.
+    // X-macros, so the zone table below is built by the compiler.
+    #define JUMP_ZONES(Z) \
+        Z(90,52,28,84,-0.1) \
+        Z(91,62,27,78,-0.1) \
+        Z(95,74,23,72, -0.1) \
+        Z(95,74,23,70, -0.1) \
+        Z(111,95,24,75, -0.3) \
+        Z(114,94,15,84, -0.5) \
+        Z(109,100,20,81, -0.5) \
+        Z(101, 96,24,85,-0.2) \
+        Z(100, 98,25,74,-0.15) \
+        Z(95,95,25, 76, 0.0) \
+        Z(88,96,25,75, 0.) \
+        Z(85,95,24,83, 0.4) \
+        Z(93,100,24,83, 0.2) \
+        Z(110,119,25,64,-0.6) \
+        Z(100, 120,21,60, -0.2) \
+        Z(105, 115,22,62, -0.15) \
+        Z(103,103,24,66,-0.1)
+    // all run_l2r_XXXX textures share the same zone
+    #define RUN_ZONE(Z) Z(118,103,35,88,-0.5)
+    #define RUN_ZONES(Z) \
+        RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) \
+        RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z) RUN_ZONE(Z)
+
+    // same conversion as the CollisionZone constructor, fields in CollisionZone order
+    // (position, size, rotation), as is and mirrored (x and rotation negated)
+    #define ZONE(x, y, w, h, r) \
+        { float(x / 200.0 - 0.5), float(0.5 - y / 210.0), float(w / 200.0), float(h / 210.0), float(r) },
+    #define MIRRORED_ZONE(x, y, w, h, r) \
+        { -float(x / 200.0 - 0.5), float(0.5 - y / 210.0), float(w / 200.0), float(h / 210.0), -float(r) },
+
+    // zone of each frame, as is and mirrored
+    static constexpr float Zones[2][FrameCount][5] = {
+        { JUMP_ZONES(ZONE) RUN_ZONES(ZONE) },
+        { JUMP_ZONES(MIRRORED_ZONE) RUN_ZONES(MIRRORED_ZONE) },
+    };
+    #define COUNT(x, y, w, h, r) + 1
+    static_assert(0 JUMP_ZONES(COUNT) RUN_ZONES(COUNT) == FrameCount, "one zone per frame");
+
+    #undef COUNT
+    #undef MIRRORED_ZONE
+    #undef ZONE
+    #undef RUN_ZONES
+    #undef RUN_ZONE
+    #undef JUMP_ZONES
+
+    // textures of runner frames, in frame order
+    static const hash_t Textures[FrameCount] = {
+        HASH("jump_l2r_0000", 0x955adbfa),
+        HASH("jump_l2r_0001", 0x2737e4c3),
+        HASH("jump_l2r_0002", 0xcfec26f2),
+        HASH("jump_l2r_0003", 0x11fae020),
+        HASH("jump_l2r_0004", 0x947eb14),
+        HASH("jump_l2r_0005", 0x5a2307d8),
+        HASH("jump_l2r_0006", 0xdf42bc08),
+        HASH("jump_l2r_0007", 0x223d3232),
+        HASH("jump_l2r_0008", 0x70ba05a2),
+        HASH("jump_l2r_0009", 0x4d5e5e36),
+        HASH("jump_l2r_0010", 0x750568e5),
+        HASH("jump_l2r_0011", 0x40c86c9),
+        HASH("jump_l2r_0012", 0x903325ff),
+        HASH("jump_l2r_0013", 0x693e3cfa),
+        HASH("jump_l2r_0014", 0x6b426fdc),
+        HASH("jump_l2r_0015", 0xeb11f32d),
+        HASH("jump_l2r_0016", 0x79836412),
+        HASH("run_l2r_0000", 0xb8ad589b),
+        HASH("run_l2r_0001", 0x7b3f138f),
+        HASH("run_l2r_0002", 0x78314a50),
+        HASH("run_l2r_0003", 0x8b603aa4),
+        HASH("run_l2r_0004", 0x389a733f),
+        HASH("run_l2r_0005", 0xbe9abda1),
+        HASH("run_l2r_0006", 0xdf402b6),
+        HASH("run_l2r_0007", 0x43683eff),
+        HASH("run_l2r_0008", 0x8d92bfc1),
+        HASH("run_l2r_0009", 0x72a0da7b),
+        HASH("run_l2r_0010", 0xf1bf0d23),
+        HASH("run_l2r_0011", 0xf52198f6),
+    };
+
+    // Perfect hash of Textures: multiplier was searched offline so that no two textures
+    // share a slot. It must be searched again if a frame is added.
+    static const uint32_t Multiplier = 0x957af525;
+    static constexpr int slot(hash_t texture) {
+        return (uint32_t)(texture * Multiplier) >> 26;
+    }
+    // index in Textures of each slot (-1: empty)
+    static constexpr int8_t Slots[64] = {
+        5, 17, -1, -1, -1, -1, -1, -1, 3, -1, -1, -1, -1, 26, 15, -1,
+        -1, -1, 8, -1, 12, 13, -1, 10, -1, 6, 27, -1, 14, 2, 16, -1,
+        -1, 19, 7, -1, -1, 21, -1, 25, 20, -1, 28, 1, -1, 22, 18, -1,
+        23, -1, 11, -1, 9, 4, -1, -1, 0, -1, -1, -1, 24, -1, -1, -1,
+    };
+
+    // Table file layout (little endian):
+    //  - "RRCZ", uint16 version, uint16 frame count
+    //  - uint32 texture hash of each frame, in Textures order
+    //  - zones, with the same layout as Zones
+    static const char TableMagic[4] = { 'R', 'R', 'C', 'Z' };
+    static const uint16_t TableVersion = 1;
+    static const unsigned TableHeaderSize = 8;
+    static const unsigned TableZonesOffset = TableHeaderSize + sizeof(Textures);
+    static const unsigned TableSize = TableZonesOffset + sizeof(Zones);
+    static_assert(sizeof(CollisionZone) == 5 * sizeof(float), "table zones are used in place");
+
+    // zones in use: compiled ones, or those of a table
+    static const CollisionZone (*table)[FrameCount] = reinterpret_cast<const CollisionZone (*)[FrameCount]>(Zones);
+
+    const CollisionZone& frame(int frame, bool mirrored) {
+        return table[mirrored ? 1 : 0][frame];
+    }
+
+    const CollisionZone* find(hash_t texture, bool mirrored) {
+        const int t = Slots[slot(texture)];
+        if (t < 0 || Textures[t] != texture)
+            return 0;
+        return &frame(t, mirrored);
+    }
+
+    bool use(const uint8_t* data, unsigned size) {
+        if (!data || size != TableSize || memcmp(data, TableMagic, 4)
+            || reinterpret_cast<uintptr_t>(data) % alignof(CollisionZone))
+            return false;
+        uint16_t version, count;
+        memcpy(&version, data + 4, 2);
+        memcpy(&count, data + 6, 2);
+        // frames must match the ones the perfect hash was built for
+        if (version != TableVersion || count != FrameCount
+            || memcmp(data + TableHeaderSize, Textures, sizeof(Textures)))
+            return false;
+        table = reinterpret_cast<const CollisionZone (*)[FrameCount]>(data + TableZonesOffset);
+        return true;
+    }
+
+    bool map(const std::string& path) {
+#if COLLISION_USE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        void* m = MAP_FAILED;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == TableSize) {
+            m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (m == MAP_FAILED)
+            return false;
+        if (!use(static_cast<const uint8_t*>(m), TableSize)) {
+            munmap(m, TableSize);
+            return false;
+        }
+        return true;
+#else
+        static std::vector<uint8_t> buffer;
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        std::vector<uint8_t> content(TableSize);
+        const bool ok = (fread(&content[0], TableSize, 1, file) == 1 && fgetc(file) == EOF);
+        fclose(file);
+        if (!ok || !use(&content[0], TableSize))
+            return false;
+        // previous buffer isn't referenced anymore
+        buffer.swap(content);
+        return true;
+#endif
+    }
+}
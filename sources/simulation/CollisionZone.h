@@ -0,0 +1,62 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <cstdint>
+
+#include "base/Entity.h"
+
+struct CollisionZone {
+    CollisionZone(float x=0,float y=0,float w=0, float h=0, float r=0) {
+        size.x = w / 200.0; size.y = h / 210.0;
+        position.x = x / 200.0 - 0.5;// + size.X * 0.5;
+        position.y = 0.5 - y / 210.0;// - size.Y * 0.5;
+        rotation = r;
+    }
+    glm::vec2 position, size;
+    float rotation;
+};
+
+// Runner hitboxes, relative to runner size (shared by RunnerSystem and SessionSimulator)
+namespace RunnerCollision {
+    // jump_l2r_XXXX and run_l2r_XXXX texture counts
+    const int JumpFrameCount = 17;
+    const int RunFrameCount = 12;
+
+    // frames are numbered jump_l2r_XXXX first, then run_l2r_XXXX
+    const int FrameCount = JumpFrameCount + RunFrameCount;
+    inline int runFrame(int run) { return JumpFrameCount + run; }
+
+    // Zone of a runner frame texture, mirrored for runners going right to left.
+    // Returns 0 for any other texture.
+    const CollisionZone* find(hash_t texture, bool mirrored);
+    // same, by frame number
+    const CollisionZone& frame(int frame, bool mirrored);
+
+    // Replaces the compiled zones by a table built from the sprites alpha masks
+    // (see tools/extract_collision_zones.py). The table is used in place, so data
+    // must stay valid as long as zones are looked up. Returns false and keeps the
+    // current zones if data isn't a valid table.
+    bool use(const uint8_t* data, unsigned size);
+    // same, with a memory mapped file (never unmapped)
+    bool map(const std::string& path);
+}
@@ -0,0 +1,94 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+/*
+ * Static interval tree on x: intervals are sorted by min, and form an implicit balanced
+ * tree (the middle of a range is the root of its subtree) where each node knows the
+ * highest max of its subtree. Queries visit O(log n + matches) nodes.
+ */
+class IntervalTree {
+    public:
+        void clear() {
+            nodes.clear();
+        }
+
+        void add(float min, float max, int id) {
+            Node n;
+            n.min = min;
+            n.max = n.subtreeMax = max;
+            n.id = id;
+            nodes.push_back(n);
+        }
+
+        // to be called once intervals are added, before any query
+        void build() {
+            std::sort(nodes.begin(), nodes.end(), [] (const Node& a, const Node& b) -> bool {
+                return a.min < b.min || (a.min == b.min && a.id < b.id);
+            });
+            build(0, nodes.size());
+        }
+
+        bool empty() const { return nodes.empty(); }
+
+        // calls f(id) for each interval overlapping [min, max], by increasing interval min
+        template<typename F>
+        void query(float min, float max, const F& f) const {
+            query(0, nodes.size(), min, max, f);
+        }
+
+    private:
+        struct Node {
+            float min, max, subtreeMax;
+            int id;
+        };
+
+        float build(int begin, int end) {
+            if (begin >= end)
+                return -1e30f;
+            const int mid = (begin + end) / 2;
+            Node& n = nodes[mid];
+            n.subtreeMax = std::max(n.max, std::max(build(begin, mid), build(mid + 1, end)));
+            return n.subtreeMax;
+        }
+
+        template<typename F>
+        void query(int begin, int end, float min, float max, const F& f) const {
+            if (begin >= end)
+                return;
+            const int mid = (begin + end) / 2;
+            const Node& n = nodes[mid];
+            // nothing in this subtree goes far enough
+            if (n.subtreeMax < min)
+                return;
+            query(begin, mid, min, max, f);
+            // this node and its right subtree start too late
+            if (n.min > max)
+                return;
+            if (n.max >= min)
+                f(n.id);
+            query(mid + 1, end, min, max, f);
+        }
+
+        std::vector<Node> nodes;
+};
@@ -0,0 +1,54 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "JumpTrackArena.h"
+
+#include "base/Log.h"
+
+#include <algorithm>
+
+void JumpTrackArena::init(int trackCount, int pJumpsPerTrack) {
+    jumpsPerTrack = pJumpsPerTrack;
+    maxTracks = trackCount;
+    records.assign(trackCount * jumpsPerTrack * 2, 0.0f);
+    counts.clear();
+    counts.reserve(trackCount);
+}
+
+int JumpTrackArena::createTrack() {
+    if ((int)counts.size() >= maxTracks) {
+        // endless sessions: tracks layout doesn't depend on their count, so existing records stay in place
+        maxTracks = std::max(1, maxTracks * 2);
+        LOGI("Jump tracks grown to " << maxTracks);
+        records.resize(maxTracks * jumpsPerTrack * 2, 0.0f);
+    }
+    counts.push_back(0);
+    return counts.size() - 1;
+}
+
+bool JumpTrackArena::push(int track, float t, float d) {
+    if (counts[track] >= jumpsPerTrack) {
+        LOGW("Jump track " << track << " is full, jump ignored");
+        return false;
+    }
+    const int o = offset(track, counts[track]++);
+    records[o] = t;
+    records[o + 1] = d;
+    return true;
+}
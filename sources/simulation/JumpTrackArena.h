@@ -0,0 +1,65 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+
+/*
+ * Jump tracks (recorded inputs, replayed by ghosts) of all runners of a session.
+ * Records are fixed size (start time relative to runner start, duration) and stored
+ * in a single buffer allocated by init (and grown if more tracks are needed):
+ * track t owns the slots [t * jumpsPerTrack, (t + 1) * jumpsPerTrack).
+ */
+class JumpTrackArena {
+    public:
+        // a run crosses the level in ~3s per screen, and a jump (up and down) takes ~0.3s
+        static const int JumpsPerScreen = 11;
+        // enough for a param::LevelSize screens level (~9s runs)
+        static const int DefaultJumpsPerTrack = 32;
+        // jumps per track needed by a levelSize screens level (Long runs last ~90s)
+        static int jumpsPerTrackFor(int levelSize) {
+            return levelSize * JumpsPerScreen > DefaultJumpsPerTrack ? levelSize * JumpsPerScreen : DefaultJumpsPerTrack;
+        }
+
+        JumpTrackArena() : jumpsPerTrack(0), maxTracks(0) {}
+
+        void init(int trackCount, int jumpsPerTrack = DefaultJumpsPerTrack);
+        // returns id of the new track
+        int createTrack();
+        int trackCount() const { return counts.size(); }
+
+        int size(int track) const { return counts[track]; }
+        bool empty(int track) const { return counts[track] == 0; }
+        float time(int track, int jump) const { return records[offset(track, jump)]; }
+        float duration(int track, int jump) const { return records[offset(track, jump) + 1]; }
+        float& lastDuration(int track) { return records[offset(track, counts[track] - 1) + 1]; }
+
+        // returns false (and ignores the jump) if track is full
+        bool push(int track, float time, float duration);
+
+    private:
+        int offset(int track, int jump) const { return (track * jumpsPerTrack + jump) * 2; }
+
+    public:
+        // raw data, public for serialization
+        int jumpsPerTrack, maxTracks;
+        std::vector<float> records;
+        std::vector<int> counts;
+};
@@ -0,0 +1,209 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "LevelChunks.h"
+
+#include "base/Log.h"
+
+#include "SessionRandom.h"
+
+#include <cmath>
+
+namespace ChunkState {
+    enum Enum {
+        Missing,
+        Requested,
+        Generated
+    };
+}
+
+LevelLayout::LevelLayout(float pLeft, float pChunkWidth, int pChunkCount, int pCoinsPerChunk, float pCoinHeightMin, float pCoinHeightMax) :
+    left(pLeft), chunkWidth(pChunkWidth), chunkCount(pChunkCount), coinsPerChunk(pCoinsPerChunk),
+    coinHeightMin(pCoinHeightMin), coinHeightMax(pCoinHeightMax) {
+}
+
+int LevelLayout::chunkAt(float x) const {
+    return glm::clamp((int)glm::floor((x - left) / chunkWidth), 0, chunkCount - 1);
+}
+
+void LevelChunks::generateCoins(uint32_t seed, const LevelLayout& layout, int chunk, glm::vec2* out) {
+    // each chunk has its own sequence
+    SessionRandom random(seed ^ (0x9e3779b9u * (chunk + 1)));
+
+    // coins stay 1 apart, from the coins of neighbour chunks too, and 1 away from level ends
+    const float chunkLeft = layout.left + chunk * layout.chunkWidth;
+    const float minX = chunkLeft + ((chunk == 0) ? 1 : 0.5);
+    const float maxX = chunkLeft + layout.chunkWidth - ((chunk == layout.chunkCount - 1) ? 1 : 0.5);
+
+    placeCoins(random, layout.coinsPerChunk, minX, maxX, 1, layout.coinHeightMin, layout.coinHeightMax, out);
+}
+
+void LevelChunks::placeCoins(SessionRandom& random, int count, float minX, float maxX, float spacing,
+    float heightMin, float heightMax, glm::vec2* out) {
+    if (count <= 0)
+        return;
+    const double slack = (maxX - minX) - (count - 1) * (double)spacing;
+    LOGF_IF(slack < 0, "Can't place " << count << " coins " << spacing << " apart in [" << minX << ", " << maxX << "]");
+
+    // count + 1 exponential gaps; their running sums over the total are count sorted uniforms
+    double sum = 0;
+    for (int i=0; i<count; i++) {
+        out[i].x = -std::log(1.0 - random.Float(0, 1));
+        out[i].y = random.Float(heightMin, heightMax);
+        sum += out[i].x;
+    }
+    sum -= std::log(1.0 - random.Float(0, 1));
+
+    const double scale = slack / sum;
+    double x = minX;
+    for (int i=0; i<count; i++) {
+        x += out[i].x * scale;
+        out[i].x = x;
+        x += spacing;
+    }
+}
+
+std::vector<glm::vec2> LevelChunks::generateCoins(uint32_t seed, const LevelLayout& layout) {
+    std::vector<glm::vec2> coins(layout.coinCount());
+    for (int c=0; c<layout.chunkCount; c++) {
+        generateCoins(seed, layout, c, &coins[c * layout.coinsPerChunk]);
+    }
+    return coins;
+}
+
+std::vector<glm::vec3> LevelChunks::generatePlatforms(SessionRandom& random, int count, int rows, float heightMin, float heightMax, float levelWidth) {
+    std::vector<glm::vec3> platforms;
+    platforms.reserve(count);
+
+    const int perRow = (count + rows - 1) / rows;
+    const float slot = (levelWidth - 2) / perRow;
+    const float rowHeight = (heightMax - heightMin) / rows;
+    for (int i=0; i<count; i++) {
+        const float width = random.Float(slot * 0.5f, slot * 0.9f);
+        const float x = -levelWidth * 0.5 + 1 + slot * (i % perRow) + random.Float(width * 0.5f, slot - width * 0.5f);
+        const float y = heightMin + rowHeight * ((i / perRow) + random.Float(0.3f, 0.7f));
+        platforms.push_back(glm::vec3(x, y, width));
+    }
+    return platforms;
+}
+
+LevelStreamer::LevelStreamer() : seed(0), quit(false) {
+}
+
+LevelStreamer::~LevelStreamer() {
+    stop();
+}
+
+void LevelStreamer::start(uint32_t pSeed, const LevelLayout& pLayout) {
+    stop();
+    seed = pSeed;
+    layout = pLayout;
+    positions.assign(layout.coinCount(), glm::vec2(0.0f));
+    states.assign(layout.chunkCount, ChunkState::Missing);
+    quit = false;
+#if !SAC_EMSCRIPTEN
+    worker = std::thread(&LevelStreamer::workerLoop, this);
+#endif
+}
+
+void LevelStreamer::stop() {
+#if !SAC_EMSCRIPTEN
+    if (worker.joinable()) {
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            quit = true;
+        }
+        wakeUp.notify_all();
+        worker.join();
+    }
+#endif
+    states.clear();
+    pending.clear();
+    ready.clear();
+}
+
+bool LevelStreamer::isStarted(uint32_t pSeed, const LevelLayout& pLayout) const {
+    return !states.empty() && seed == pSeed && layout.left == pLayout.left &&
+        layout.chunkWidth == pLayout.chunkWidth && layout.chunkCount == pLayout.chunkCount &&
+        layout.coinsPerChunk == pLayout.coinsPerChunk;
+}
+
+void LevelStreamer::request(int chunk) {
+    if (chunk < 0 || chunk >= (int)states.size())
+        return;
+#if SAC_EMSCRIPTEN
+    // no threads there
+    if (states[chunk] == ChunkState::Missing) {
+        LevelChunks::generateCoins(seed, layout, chunk, &positions[chunk * layout.coinsPerChunk]);
+        states[chunk] = ChunkState::Generated;
+        ready.push_back(chunk);
+    }
+#else
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        if (states[chunk] != ChunkState::Missing)
+            return;
+        states[chunk] = ChunkState::Requested;
+        pending.push_back(chunk);
+    }
+    wakeUp.notify_one();
+#endif
+}
+
+void LevelStreamer::wait(int chunk) {
+    request(chunk);
+#if !SAC_EMSCRIPTEN
+    std::unique_lock<std::mutex> l(mutex);
+    if (states[chunk] != ChunkState::Generated)
+        LOGW("Waiting for level chunk " << chunk);
+    generated.wait(l, [this, chunk] () -> bool { return states[chunk] == ChunkState::Generated; });
+#endif
+}
+
+void LevelStreamer::collect(std::vector<int>& chunks) {
+#if !SAC_EMSCRIPTEN
+    std::unique_lock<std::mutex> l(mutex);
+#endif
+    chunks.insert(chunks.end(), ready.begin(), ready.end());
+    ready.clear();
+}
+
+void LevelStreamer::workerLoop() {
+    while (true) {
+        int chunk;
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            wakeUp.wait(l, [this] () -> bool { return quit || !pending.empty(); });
+            if (quit)
+                return;
+            chunk = pending.front();
+            pending.pop_front();
+        }
+
+        // chunks don't overlap in positions, so this runs unlocked
+        LevelChunks::generateCoins(seed, layout, chunk, &positions[chunk * layout.coinsPerChunk]);
+
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            states[chunk] = ChunkState::Generated;
+            ready.push_back(chunk);
+        }
+        generated.notify_all();
+    }
+}
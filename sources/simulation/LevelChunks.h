@@ -0,0 +1,108 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <glm/glm.hpp>
+
+#include "SessionRandom.h"
+
+/*
+ * Levels are a row of chunks, one screen wide each. Coins of a chunk only depend on the
+ * session seed and the chunk index, so chunks can be generated in any order and on any
+ * thread: coin k of chunk c is always coin c * coinsPerChunk + k of the level, and level
+ * coins are sorted left to right.
+ */
+struct LevelLayout {
+    LevelLayout(float left = 0, float chunkWidth = 0, int chunkCount = 0, int coinsPerChunk = 0,
+        float coinHeightMin = 0, float coinHeightMax = 0);
+
+    float left, chunkWidth;
+    int chunkCount, coinsPerChunk;
+    float coinHeightMin, coinHeightMax;
+
+    float width() const { return chunkWidth * chunkCount; }
+    float right() const { return left + width(); }
+    int coinCount() const { return chunkCount * coinsPerChunk; }
+    // chunk containing x, clamped to the level
+    int chunkAt(float x) const;
+};
+
+namespace LevelChunks {
+    // count coins sorted left to right in [minX, maxX], at least spacing apart, in O(count).
+    // Gaps left once coins are packed are split by uniform order statistics (normalized
+    // exponential spacings), so every valid layout is equally likely and nothing is retried.
+    void placeCoins(SessionRandom& random, int count, float minX, float maxX, float spacing,
+        float heightMin, float heightMax, glm::vec2* out);
+    // writes the coins of chunk, sorted left to right, to out[0, coinsPerChunk)
+    void generateCoins(uint32_t seed, const LevelLayout& layout, int chunk, glm::vec2* out);
+    // every coin of the level at once
+    std::vector<glm::vec2> generateCoins(uint32_t seed, const LevelLayout& layout);
+
+    // Level3 platforms (center x, top y, width), spread on rows, each row being split in as
+    // many slots as it has platforms: a platform stays in its slot, so they never overlap.
+    std::vector<glm::vec3> generatePlatforms(SessionRandom& random, int count, int rows, float heightMin, float heightMax, float levelWidth);
+}
+
+/*
+ * Generates level chunks on a background thread, so the chunk ahead of the camera is ready
+ * before it's needed. Coins are written in place in a level wide array; the calling thread
+ * must only read chunks returned by collect.
+ */
+class LevelStreamer {
+    public:
+        LevelStreamer();
+        ~LevelStreamer();
+
+        void start(uint32_t seed, const LevelLayout& layout);
+        void stop();
+        bool isStarted(uint32_t seed, const LevelLayout& layout) const;
+
+        // asks for chunk generation, ignored if already asked
+        void request(int chunk);
+        // blocks until chunk is generated (camera caught up with the generator)
+        void wait(int chunk);
+        // appends the chunks generated since last call
+        void collect(std::vector<int>& chunks);
+
+        const glm::vec2* coins(int chunk) const { return &positions[chunk * layout.coinsPerChunk]; }
+
+    private:
+        void workerLoop();
+
+    private:
+        uint32_t seed;
+        LevelLayout layout;
+        std::vector<glm::vec2> positions;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wakeUp, generated;
+        // chunks state, pending requests and generated chunks not collected yet (under mutex)
+        std::vector<uint8_t> states;
+        std::deque<int> pending;
+        std::vector<int> ready;
+        bool quit;
+};
@@ -0,0 +1,366 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Replay.h"
+#include "Bytes.h"
+
+#include "base/Log.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#if !defined(_WIN32) && !SAC_EMSCRIPTEN
+#define REPLAY_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const char Magic[4] = { 'R', 'R', 'R', 'P' };
+static const uint16_t Version = 1;
+static const unsigned HeaderSize = 16;
+static const unsigned IndexEntrySize = 16;
+static const char SegmentPrefix[] = "replays-";
+static const char SegmentSuffix[] = ".bin";
+
+static uint32_t toTicks(float t, unsigned ticksPerSecond) {
+    return (t <= 0) ? 0 : (uint32_t)floor(t * ticksPerSecond + 0.5f);
+}
+
+float Replay::quantize(float t, unsigned ticksPerSecond) {
+    // same computation as decode
+    return toTicks(t, ticksPerSecond) * (1.0f / ticksPerSecond);
+}
+
+void Replay::encode(const ReplayData& replay, unsigned ticksPerSecond, std::vector<uint8_t>& out) {
+    Bytes::writeVarint(out, replay.level);
+    Bytes::writeVarint(out, replay.score);
+
+    Bytes::writeVarint(out, replay.runnerStartTimes.size());
+    for (float t: replay.runnerStartTimes) {
+        Bytes::writeVarint(out, toTicks(t, ticksPerSecond));
+    }
+
+    const JumpTrackArena& jumps = replay.jumps;
+    Bytes::writeVarint(out, jumps.trackCount());
+    for (int track=0; track<jumps.trackCount(); track++) {
+        Bytes::writeVarint(out, jumps.size(track));
+        uint32_t previous = 0;
+        for (int j=0; j<jumps.size(track); j++) {
+            // jumps are recorded in order, so deltas are small and positive
+            const uint32_t start = std::max(previous, toTicks(jumps.time(track, j), ticksPerSecond));
+            Bytes::writeVarint(out, start - previous);
+            Bytes::writeVarint(out, toTicks(jumps.duration(track, j), ticksPerSecond));
+            previous = start;
+        }
+    }
+}
+
+bool Replay::decode(const uint8_t* p, unsigned size, unsigned ticksPerSecond, ReplayData& out) {
+    const uint8_t* end = p + size;
+    const float tick = 1.0f / ticksPerSecond;
+    uint32_t v, count;
+
+    if (!Bytes::readVarint(p, end, v)) return false;
+    out.level = v;
+    if (!Bytes::readVarint(p, end, v)) return false;
+    out.score = v;
+
+    if (!Bytes::readVarint(p, end, count) || count > size) return false;
+    out.runnerStartTimes.resize(count);
+    for (unsigned i=0; i<count; i++) {
+        if (!Bytes::readVarint(p, end, v)) return false;
+        out.runnerStartTimes[i] = v * tick;
+    }
+
+    if (!Bytes::readVarint(p, end, count) || count > size) return false;
+    const uint8_t* tracks = p;
+    // tracks capacity is the longest track
+    uint32_t longest = 0;
+    for (unsigned t=0; t<count; t++) {
+        uint32_t jumpCount;
+        if (!Bytes::readVarint(p, end, jumpCount) || jumpCount > size) return false;
+        longest = std::max(longest, jumpCount);
+        for (unsigned j=0; j<jumpCount * 2; j++) {
+            if (!Bytes::readVarint(p, end, v)) return false;
+        }
+    }
+
+    out.jumps.init(count, std::max(longest, (uint32_t)JumpTrackArena::DefaultJumpsPerTrack));
+    p = tracks;
+    for (unsigned t=0; t<count; t++) {
+        uint32_t jumpCount, start = 0, duration;
+        Bytes::readVarint(p, end, jumpCount);
+        const int track = out.jumps.createTrack();
+        for (unsigned j=0; j<jumpCount; j++) {
+            Bytes::readVarint(p, end, v);
+            Bytes::readVarint(p, end, duration);
+            start += v;
+            out.jumps.push(track, start * tick, duration * tick);
+        }
+    }
+    return true;
+}
+
+ReplayArchive::ReplayArchive() : data(0), size(0), replayCount(0), ticks(0), mapped(false) {
+}
+
+ReplayArchive::~ReplayArchive() {
+    close();
+}
+
+bool ReplayArchive::open(const std::string& path) {
+    close();
+#if REPLAY_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(m);
+            size = st.st_size;
+            mapped = true;
+        }
+    }
+    ::close(fd);
+#else
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    buffer.resize(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    if (!buffer.empty() && fread(&buffer[0], buffer.size(), 1, file) == 1) {
+        data = &buffer[0];
+        size = buffer.size();
+    }
+    fclose(file);
+#endif
+    if (!validate()) {
+        LOGW("Invalid replay archive '" << path << "'");
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ReplayArchive::open(const uint8_t* pData, unsigned pSize) {
+    close();
+    data = pData;
+    size = pSize;
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ReplayArchive::close() {
+#if REPLAY_USE_MMAP
+    if (mapped)
+        munmap(const_cast<uint8_t*>(data), size);
+#endif
+    buffer.clear();
+    data = 0;
+    size = replayCount = ticks = 0;
+    mapped = false;
+}
+
+bool ReplayArchive::validate() {
+    if (!data || size < HeaderSize || memcmp(data, Magic, 4) || Bytes::read16(data + 4) != Version)
+        return false;
+    ticks = Bytes::read16(data + 6);
+    replayCount = Bytes::read32(data + 8);
+    if (ticks == 0 || replayCount > (size - HeaderSize) / IndexEntrySize)
+        return false;
+    for (unsigned i=0; i<replayCount; i++) {
+        const ReplayIndexEntry e = entry(i);
+        if (e.offset < HeaderSize + replayCount * IndexEntrySize || e.offset > size || e.size > size - e.offset)
+            return false;
+    }
+    return true;
+}
+
+ReplayIndexEntry ReplayArchive::entry(unsigned i) const {
+    const uint8_t* p = data + HeaderSize + i * IndexEntrySize;
+    ReplayIndexEntry e;
+    e.seed = Bytes::read32(p);
+    e.score = Bytes::read32(p + 4);
+    e.offset = Bytes::read32(p + 8);
+    e.size = Bytes::read32(p + 12);
+    return e;
+}
+
+bool ReplayArchive::read(unsigned i, ReplayData& out) const {
+    const ReplayIndexEntry e = entry(i);
+    out.seed = e.seed;
+    return Replay::decode(data + e.offset, e.size, ticks, out);
+}
+
+ReplayArchiveWriter::ReplayArchiveWriter(unsigned ticksPerSecond) : ticks(ticksPerSecond) {
+}
+
+void ReplayArchiveWriter::add(const ReplayData& replay) {
+    ReplayIndexEntry e;
+    e.seed = replay.seed;
+    e.score = replay.score;
+    e.offset = payloads.size();
+    Replay::encode(replay, ticks, payloads);
+    e.size = payloads.size() - e.offset;
+    index.push_back(e);
+}
+
+void ReplayArchiveWriter::add(const ReplayArchive& archive, unsigned i) {
+    if (archive.ticksPerSecond() != ticks) {
+        ReplayData replay;
+        if (archive.read(i, replay))
+            add(replay);
+        return;
+    }
+    ReplayIndexEntry e = archive.entry(i);
+    const uint8_t* p = archive.payload(i);
+    e.offset = payloads.size();
+    payloads.insert(payloads.end(), p, p + e.size);
+    index.push_back(e);
+}
+
+std::vector<uint8_t> ReplayArchiveWriter::bytes() const {
+    const unsigned payloadsOffset = HeaderSize + index.size() * IndexEntrySize;
+    std::vector<uint8_t> out(payloadsOffset, 0);
+
+    memcpy(&out[0], Magic, 4);
+    Bytes::write16(&out[4], Version);
+    Bytes::write16(&out[6], ticks);
+    Bytes::write32(&out[8], index.size());
+
+    for (unsigned i=0; i<index.size(); i++) {
+        uint8_t* p = &out[HeaderSize + i * IndexEntrySize];
+        Bytes::write32(p, index[i].seed);
+        Bytes::write32(p + 4, index[i].score);
+        Bytes::write32(p + 8, payloadsOffset + index[i].offset);
+        Bytes::write32(p + 12, index[i].size);
+    }
+    out.insert(out.end(), payloads.begin(), payloads.end());
+    return out;
+}
+
+bool ReplayArchiveWriter::save(const std::string& path) const {
+    const std::vector<uint8_t> b = bytes();
+    // written aside then renamed, so a crash never leaves a half written archive
+    const std::string tmp = path + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (!file) {
+        LOGW("Unable to write replay archive '" << tmp << "'");
+        return false;
+    }
+    bool ok = (fwrite(&b[0], b.size(), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        LOGW("Unable to write replay archive '" << path << "'");
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string Replay::segmentPath(const std::string& directory, uint32_t timestamp) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s%u%s", SegmentPrefix, timestamp, SegmentSuffix);
+    return directory + "/" + name;
+}
+
+std::vector<std::string> Replay::listSegments(const std::string& directory) {
+    std::vector<std::pair<unsigned long, std::string> > found;
+#if REPLAY_USE_MMAP
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return std::vector<std::string>();
+    const size_t prefixLength = strlen(SegmentPrefix);
+    while (struct dirent* d = readdir(dir)) {
+        // replays-<timestamp>.bin only (not the .tmp being written)
+        if (strncmp(d->d_name, SegmentPrefix, prefixLength))
+            continue;
+        char* end = 0;
+        const unsigned long timestamp = strtoul(d->d_name + prefixLength, &end, 10);
+        if (end == d->d_name + prefixLength || strcmp(end, SegmentSuffix))
+            continue;
+        found.push_back(std::make_pair(timestamp, directory + "/" + d->d_name));
+    }
+    closedir(dir);
+#else
+    LOGW("Replay segments can't be listed on this platform");
+#endif
+    std::sort(found.begin(), found.end());
+    std::vector<std::string> paths;
+    for (const auto& f: found) {
+        paths.push_back(f.second);
+    }
+    return paths;
+}
+
+unsigned Replay::pruneSegments(const std::string& directory, unsigned keep) {
+    const std::vector<std::string> segments = listSegments(directory);
+    unsigned deleted = 0;
+    for (unsigned i=0; i + keep < segments.size(); i++) {
+        if (remove(segments[i].c_str()) == 0) {
+            deleted++;
+        } else {
+            LOGW("Unable to delete replay archive '" << segments[i] << "'");
+        }
+    }
+    return deleted;
+}
+
+unsigned ReplayCorpus::open(const std::string& directory) {
+    close();
+    for (const auto& path: Replay::listSegments(directory)) {
+        std::unique_ptr<ReplayArchive> archive(new ReplayArchive());
+        if (archive->open(path))
+            segments.push_back(std::move(archive));
+    }
+    return segments.size();
+}
+
+void ReplayCorpus::close() {
+    segments.clear();
+}
+
+unsigned ReplayCorpus::count() const {
+    unsigned c = 0;
+    for (const auto& s: segments) {
+        c += s->count();
+    }
+    return c;
+}
+
+bool ReplayCorpus::read(unsigned i, ReplayData& out) const {
+    for (const auto& s: segments) {
+        if (i < s->count())
+            return s->read(i, out);
+        i -= s->count();
+    }
+    return false;
+}
@@ -0,0 +1,150 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "base/Entity.h"
+
+#include "JumpTrackArena.h"
+
+/*
+ * Replay files: everything needed to play a session again (seed of the coins layout,
+ * ghosts restart delays, jump tracks).
+ *
+ * An archive holds many replays and is designed to be memory-mapped:
+ *  - Header (16 bytes): magic "RRRP", u16 version, u16 ticks per second, u32 count, u32 reserved
+ *  - Index: count x ReplayIndexEntry (16 bytes each), readable without decoding anything
+ *  - Payloads, one per replay, as unsigned LEB128 varints:
+ *      level, score,
+ *      start times count, then each start time (in ticks),
+ *      track count, then for each track: jump count, then for each jump:
+ *          delta with previous jump start (in ticks), duration (in ticks)
+ * Times are quantized to the archive tick rate. Integers are little-endian. Sessions draw
+ * their start times already quantized (see Replay::quantize), so they're replayed exactly.
+ *
+ * Archives are never appended to: the game writes one archive (segment) per app session,
+ * so the replays corpus is the directory of segments (replays-<timestamp>.bin), each of
+ * them mapped on its own. Only the most recent segments are kept (see pruneSegments).
+ */
+struct ReplayData {
+    ReplayData() : seed(0), level(0), score(0) {}
+
+    hash_t seed;
+    int level, score;
+    // ghosts restart delays actually used, in order
+    std::vector<float> runnerStartTimes;
+    // one track per runner, in creation order
+    JumpTrackArena jumps;
+};
+
+struct ReplayIndexEntry {
+    uint32_t seed;
+    int32_t score;
+    // payload location, from the beginning of the archive
+    uint32_t offset, size;
+};
+
+namespace Replay {
+    const unsigned DefaultTicksPerSecond = 120;
+
+    void encode(const ReplayData& replay, unsigned ticksPerSecond, std::vector<uint8_t>& out);
+    bool decode(const uint8_t* data, unsigned size, unsigned ticksPerSecond, ReplayData& out);
+
+    // t rounded to the nearest tick, as decode will return it
+    float quantize(float t, unsigned ticksPerSecond = DefaultTicksPerSecond);
+
+    // segment of the directory written at timestamp
+    std::string segmentPath(const std::string& directory, uint32_t timestamp);
+    // segments of the directory, oldest first
+    std::vector<std::string> listSegments(const std::string& directory);
+    // deletes the oldest segments, so that at most keep are left. Returns how many were deleted
+    unsigned pruneSegments(const std::string& directory, unsigned keep);
+}
+
+// Read-only view of an archive. Nothing is decoded until read() is called.
+class ReplayArchive {
+    public:
+        ReplayArchive();
+        ~ReplayArchive();
+
+        // maps the file in memory
+        bool open(const std::string& path);
+        // uses a memory block owned by the caller
+        bool open(const uint8_t* data, unsigned size);
+        void close();
+
+        unsigned count() const { return replayCount; }
+        unsigned ticksPerSecond() const { return ticks; }
+        ReplayIndexEntry entry(unsigned i) const;
+        const uint8_t* payload(unsigned i) const { return data + entry(i).offset; }
+
+        bool read(unsigned i, ReplayData& out) const;
+
+    private:
+        bool validate();
+
+    private:
+        const uint8_t* data;
+        unsigned size, replayCount, ticks;
+        bool mapped;
+        // file content, when it cannot be mapped
+        std::vector<uint8_t> buffer;
+};
+
+// Every replay of a directory of segments, oldest first
+class ReplayCorpus {
+    public:
+        // invalid segments are skipped
+        unsigned open(const std::string& directory);
+        void close();
+
+        unsigned segmentCount() const { return segments.size(); }
+        const ReplayArchive& segment(unsigned i) const { return *segments[i]; }
+
+        unsigned count() const;
+        // i-th replay, counted over every segment
+        bool read(unsigned i, ReplayData& out) const;
+
+    private:
+        std::vector<std::unique_ptr<ReplayArchive> > segments;
+};
+
+class ReplayArchiveWriter {
+    public:
+        ReplayArchiveWriter(unsigned ticksPerSecond = Replay::DefaultTicksPerSecond);
+
+        void add(const ReplayData& replay);
+        // copy a replay from another archive (re-encoded only if tick rates differ)
+        void add(const ReplayArchive& archive, unsigned i);
+
+        unsigned count() const { return index.size(); }
+        std::vector<uint8_t> bytes() const;
+        // replaces the file atomically (written to path.tmp, then renamed)
+        bool save(const std::string& path) const;
+
+    private:
+        unsigned ticks;
+        std::vector<ReplayIndexEntry> index;
+        std::vector<uint8_t> payloads;
+};
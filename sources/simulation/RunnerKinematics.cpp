@@ -0,0 +1,232 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "RunnerKinematics.h"
+#include "RunnerRules.h"
+
+#include "../Parameters.h"
+
+#include <limits>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RUNNER_KINEMATICS_SSE 1
+#endif
+
+static const float NoJump = std::numeric_limits<float>::infinity();
+
+unsigned RunnerKinematics::add(float pX, float pY, float pSpeed, float pEndX) {
+    positionX.push_back(pX);
+    positionY.push_back(pY);
+    velocityY.push_back(0);
+    gravity.push_back(0);
+    impulseLeft.push_back(0);
+    speed.push_back(pSpeed);
+    endX.push_back(pEndX);
+    startTime.push_back(0);
+    elapsed.push_back(0);
+    jumpingSince.push_back(0);
+    jumpTime.push_back(NoJump);
+    jumpDuration.push_back(0);
+    active.push_back(~0);
+    holdForce.push_back(0);
+    events.push_back(RunnerEvent::None);
+    return size() - 1;
+}
+
+void RunnerKinematics::reserve(unsigned count) {
+    for (auto* v: { &positionX, &positionY, &velocityY, &gravity, &impulseLeft,
+        &speed, &endX, &startTime, &elapsed, &jumpingSince, &jumpTime, &jumpDuration }) {
+        v->reserve(count);
+    }
+    active.reserve(count);
+    holdForce.reserve(count);
+    events.reserve(count);
+}
+
+void RunnerKinematics::clearJump(unsigned i) {
+    jumpTime[i] = NoJump;
+    jumpDuration[i] = 0;
+}
+
+void RunnerKinematics::setJump(unsigned i, float time, float duration) {
+    jumpTime[i] = time;
+    jumpDuration[i] = duration;
+}
+
+int RunnerKinematics::advanceJump(unsigned i, float dt) {
+    if (jumpTime[i] == NoJump)
+        return RunnerEvent::None;
+
+    const int event = RunnerRules::advanceJump(elapsed[i] - startTime[i], jumpTime[i], jumpDuration[i], jumpingSince[i], dt);
+    if (event & RunnerEvent::JumpStart) {
+        impulseLeft[i] = param::MinJumpDuration;
+        gravity[i] = param::JumpHoldGravity;
+    } else if (event & RunnerEvent::JumpEnd) {
+        gravity[i] = param::FallGravity;
+    } else if (jumpingSince[i] > 0) {
+        holdForce[i] = ~0;
+    }
+    return event;
+}
+
+void RunnerKinematics::advanceScalar(float dt, unsigned from) {
+    for (unsigned i=from; i<size(); i++) {
+        events[i] = RunnerEvent::None;
+        if (!active[i])
+            continue;
+
+        elapsed[i] += dt;
+        if (elapsed[i] >= startTime[i]) {
+            positionX[i] += speed[i] * dt;
+            if ((positionX[i] > endX[i] && speed[i] > 0) ||
+                (positionX[i] < endX[i] && speed[i] < 0)) {
+                events[i] = RunnerEvent::Finished;
+                continue;
+            }
+        }
+        events[i] = advanceJump(i, dt);
+    }
+}
+
+void RunnerKinematics::integrateScalar(float dt, unsigned from) {
+    for (unsigned i=from; i<size(); i++) {
+        if (!active[i])
+            continue;
+        // forces shorter than dt are scaled down
+        float acceleration = gravity[i];
+        if (impulseLeft[i] > 0) {
+            acceleration += param::JumpImpulse * glm::min(impulseLeft[i], dt) / dt;
+            impulseLeft[i] -= dt;
+        }
+        if (holdForce[i]) {
+            acceleration += param::JumpHoldForce;
+            holdForce[i] = 0;
+        }
+        velocityY[i] += acceleration * dt;
+        positionY[i] += velocityY[i] * dt;
+    }
+}
+
+#if RUNNER_KINEMATICS_SSE
+static inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 loadMask(const int32_t* p) {
+    return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+void RunnerKinematics::advance(float dt) {
+    const unsigned count = size() & ~3u;
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 noJump = _mm_set1_ps(NoJump);
+
+    for (unsigned i=0; i<count; i+=4) {
+        const __m128 alive = loadMask(&active[i]);
+
+        __m128 elapsedV = _mm_loadu_ps(&elapsed[i]);
+        elapsedV = select(alive, _mm_add_ps(elapsedV, vdt), elapsedV);
+        const __m128 startTimeV = _mm_loadu_ps(&startTime[i]);
+        const __m128 started = _mm_and_ps(alive, _mm_cmpge_ps(elapsedV, startTimeV));
+
+        const __m128 speedV = _mm_loadu_ps(&speed[i]);
+        __m128 x = _mm_loadu_ps(&positionX[i]);
+        x = select(started, _mm_add_ps(x, _mm_mul_ps(speedV, vdt)), x);
+        const __m128 endXV = _mm_loadu_ps(&endX[i]);
+        const __m128 finished = _mm_and_ps(started, _mm_or_ps(
+            _mm_and_ps(_mm_cmpgt_ps(x, endXV), _mm_cmpgt_ps(speedV, zero)),
+            _mm_and_ps(_mm_cmplt_ps(x, endXV), _mm_cmplt_ps(speedV, zero))));
+
+        // jump timers (finished runners are reset, then handled by advanceJump)
+        const __m128 running = _mm_andnot_ps(finished, _mm_and_ps(alive, _mm_cmplt_ps(_mm_loadu_ps(&jumpTime[i]), noJump)));
+        const __m128 since = _mm_loadu_ps(&jumpingSince[i]);
+        const __m128 trigger = _mm_and_ps(running, _mm_and_ps(
+            _mm_cmpge_ps(_mm_sub_ps(elapsedV, startTimeV), _mm_loadu_ps(&jumpTime[i])),
+            _mm_cmpeq_ps(since, zero)));
+        const __m128 jumping = _mm_andnot_ps(trigger, _mm_and_ps(running, _mm_cmpgt_ps(since, zero)));
+        const __m128 sinceNext = _mm_add_ps(since, vdt);
+        const __m128 jumpEnd = _mm_and_ps(jumping, _mm_cmpgt_ps(sinceNext, _mm_loadu_ps(&jumpDuration[i])));
+        const __m128 hold = _mm_andnot_ps(jumpEnd, jumping);
+
+        _mm_storeu_ps(&elapsed[i], elapsedV);
+        _mm_storeu_ps(&positionX[i], x);
+        _mm_storeu_ps(&jumpingSince[i],
+            select(trigger, _mm_set1_ps(RunnerRules::JumpStarted),
+                select(jumpEnd, zero,
+                    select(jumping, sinceNext, since))));
+        _mm_storeu_ps(&impulseLeft[i],
+            select(trigger, _mm_set1_ps(param::MinJumpDuration), _mm_loadu_ps(&impulseLeft[i])));
+        _mm_storeu_ps(&gravity[i],
+            select(trigger, _mm_set1_ps(param::JumpHoldGravity),
+                select(jumpEnd, _mm_set1_ps(param::FallGravity), _mm_loadu_ps(&gravity[i]))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&holdForce[i]),
+            _mm_or_si128(_mm_castps_si128(hold), _mm_loadu_si128(reinterpret_cast<const __m128i*>(&holdForce[i]))));
+
+        const int f = _mm_movemask_ps(finished), t = _mm_movemask_ps(trigger), e = _mm_movemask_ps(jumpEnd);
+        for (int l=0; l<4; l++) {
+            events[i + l] = (((f >> l) & 1) ? RunnerEvent::Finished : 0) |
+                (((t >> l) & 1) ? RunnerEvent::JumpStart : 0) |
+                (((e >> l) & 1) ? RunnerEvent::JumpEnd : 0);
+        }
+    }
+    advanceScalar(dt, count);
+}
+
+void RunnerKinematics::integrate(float dt) {
+    const unsigned count = size() & ~3u;
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (unsigned i=0; i<count; i+=4) {
+        const __m128 alive = loadMask(&active[i]);
+        const __m128 hold = _mm_and_ps(alive, loadMask(&holdForce[i]));
+        __m128 impulse = _mm_loadu_ps(&impulseLeft[i]);
+        const __m128 impulsing = _mm_and_ps(alive, _mm_cmpgt_ps(impulse, zero));
+
+        __m128 acceleration = _mm_loadu_ps(&gravity[i]);
+        acceleration = select(impulsing, _mm_add_ps(acceleration,
+            _mm_div_ps(_mm_mul_ps(_mm_set1_ps(param::JumpImpulse), _mm_min_ps(impulse, vdt)), vdt)), acceleration);
+        acceleration = select(hold, _mm_add_ps(acceleration, _mm_set1_ps(param::JumpHoldForce)), acceleration);
+        impulse = select(impulsing, _mm_sub_ps(impulse, vdt), impulse);
+
+        __m128 vy = _mm_loadu_ps(&velocityY[i]);
+        vy = select(alive, _mm_add_ps(vy, _mm_mul_ps(acceleration, vdt)), vy);
+        __m128 y = _mm_loadu_ps(&positionY[i]);
+        y = select(alive, _mm_add_ps(y, _mm_mul_ps(vy, vdt)), y);
+
+        _mm_storeu_ps(&impulseLeft[i], impulse);
+        _mm_storeu_ps(&velocityY[i], vy);
+        _mm_storeu_ps(&positionY[i], y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&holdForce[i]),
+            _mm_andnot_si128(_mm_castps_si128(alive), _mm_loadu_si128(reinterpret_cast<const __m128i*>(&holdForce[i]))));
+    }
+    integrateScalar(dt, count);
+}
+#else
+void RunnerKinematics::advance(float dt) {
+    advanceScalar(dt);
+}
+
+void RunnerKinematics::integrate(float dt) {
+    integrateScalar(dt);
+}
+#endif
@@ -0,0 +1,73 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace RunnerEvent {
+    enum Enum {
+        None = 0,
+        Finished = 1 << 0,
+        JumpStart = 1 << 1,
+        JumpEnd = 1 << 2,
+    };
+}
+
+/*
+ * Per-frame runner data, stored as one array per field (structure of arrays) so
+ * all runners can be advanced in one vectorized pass. Cold data (jump tracks, coins)
+ * lives in SimRunner, or RunnerComponent (RunnerSystem keeps a slot per runner entity):
+ * only the current jump of each track is cached here, and must be refreshed with setJump()
+ * when the track changes.
+ */
+struct RunnerKinematics {
+    // returns index of the new runner
+    unsigned add(float positionX, float positionY, float speed, float endX);
+    unsigned size() const { return positionX.size(); }
+    void reserve(unsigned count);
+
+    // no jump left in track
+    void clearJump(unsigned i);
+    void setJump(unsigned i, float time, float duration);
+
+    // elapsed time, horizontal move, end of level and jump timers of all active runners.
+    // Fills 'events' ; jump state of runners which Finished is left untouched (see advanceJump).
+    void advance(float dt);
+    // scalar version of advance (reference implementation, jump timers are RunnerRules::advanceJump)
+    void advanceScalar(float dt, unsigned from = 0);
+    // jump timers of a single runner, returns a RunnerEvent mask
+    int advanceJump(unsigned i, float dt);
+
+    // vertical physics (same as PhysicsSystem, for a mass of 1)
+    void integrate(float dt);
+    void integrateScalar(float dt, unsigned from = 0);
+
+    std::vector<float> positionX, positionY, velocityY;
+    std::vector<float> gravity, impulseLeft;
+    std::vector<float> speed, endX;
+    std::vector<float> startTime, elapsed, jumpingSince;
+    // current jump of the track (time is +inf if there's none)
+    std::vector<float> jumpTime, jumpDuration;
+    // masks: 0 or ~0
+    std::vector<int32_t> active, holdForce;
+    // RunnerEvent mask, set by advance
+    std::vector<uint8_t> events;
+};
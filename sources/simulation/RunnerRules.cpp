@@ -0,0 +1,194 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "RunnerRules.h"
+
+#include "RunnerKinematics.h"
+#include "../Parameters.h"
+
+#include <glm/gtx/rotate_vector.hpp>
+
+namespace RunnerRules {
+
+bool jumpInput(JumpTrackArena& jumps, int track, bool wasTouching, float elapsed, float jumpingSince, float velocityY, float dt) {
+    if (!wasTouching) {
+        if (jumpingSince <= 0 && velocityY == 0) {
+            return jumps.push(track, elapsed, dt);
+        }
+    } else if (!jumps.empty(track)) {
+        float& d = jumps.lastDuration(track);
+        d = glm::min(d + dt, param::MaxJumpDuration);
+        return true;
+    }
+    return false;
+}
+
+int advanceJump(float runTime, float jumpTime, float jumpDuration, float& jumpingSince, float dt) {
+    if (runTime >= jumpTime && jumpingSince == 0) {
+        jumpingSince = JumpStarted;
+        return RunnerEvent::JumpStart;
+    } else if (jumpingSince > 0) {
+        jumpingSince += dt;
+        if (jumpingSince > jumpDuration) {
+            jumpingSince = 0;
+            return RunnerEvent::JumpEnd;
+        }
+    }
+    return RunnerEvent::None;
+}
+
+void KillSweep::add(int id, const Box& zone, bool ghost, float elapsed, bool leftToRight) {
+    if (ghost && elapsed < param::GhostKillDelay)
+        return;
+    Entry e;
+    e.id = id;
+    e.zone = zone;
+    e.killed = false;
+    const float extent = CoinSweep::halfExtentX(zone.size, zone.rotation);
+    const int direction = leftToRight ? 0 : 1;
+    if (ghost)
+        sweep[direction].add(0, zone.position.x - extent, zone.position.x + extent, entries.size());
+    else
+        sweep[1 - direction].add(1, zone.position.x - extent, zone.position.x + extent, entries.size());
+    entries.push_back(e);
+}
+
+Box platformBox(const glm::vec3& platform, float height) {
+    return Box(glm::vec2(platform.x, platform.y - height * 0.5), glm::vec2(platform.z, height));
+}
+
+Box switchBox(const glm::vec3& platform, int end, float platformHeight, const glm::vec2& switchSize) {
+    return Box(glm::vec2(platform.x + (end ? 0.5f : -0.5f) * platform.z, platform.y - platformHeight - switchSize.y),
+        switchSize);
+}
+
+void PlatformEdges::clear() {
+    platforms.clear();
+    activePlatforms.clear();
+    version++;
+    edgesIndex.clear();
+    dirty = false;
+}
+
+int PlatformEdges::add(const Box& platform, bool active) {
+    Edge e;
+    // computed by move
+    e.box.size = glm::vec2(-1.0f);
+    platforms.push_back(e);
+    const int i = platforms.size() - 1;
+    move(i, platform);
+    if (platforms.size() > activePlatforms.size() * 32)
+        activePlatforms.push_back(0);
+    if (active)
+        activePlatforms[i >> 5] |= 1u << (i & 31);
+    version++;
+    return i;
+}
+
+void PlatformEdges::move(int i, const Box& platform) {
+    Edge& e = platforms[i];
+    if (platform.position == e.box.position && platform.size == e.box.size && platform.rotation == e.box.rotation)
+        return;
+    e.box = platform;
+    e.right = platform.position + glm::rotate(glm::vec2(platform.size.x * 0.5, platform.size.y * 0.5), platform.rotation);
+    e.left = platform.position + glm::rotate(glm::vec2(-platform.size.x * 0.5, platform.size.y * 0.5), platform.rotation);
+    dirty = true;
+}
+
+void PlatformEdges::setActive(int i, bool active) {
+    if (isActive(i) == active)
+        return;
+    activePlatforms[i >> 5] ^= 1u << (i & 31);
+    version++;
+}
+
+void PlatformEdges::update() {
+    if (!dirty)
+        return;
+    edgesIndex.clear();
+    for (unsigned i=0; i<platforms.size(); i++) {
+        edgesIndex.add(glm::min(platforms[i].left.x, platforms[i].right.x),
+            glm::max(platforms[i].left.x, platforms[i].right.x), i);
+    }
+    edgesIndex.build();
+    dirty = false;
+}
+
+PlatformerEvent::Enum PlatformEdges::step(float velocityY, const glm::vec2& previous, const glm::vec2& feet,
+    bool& standing, int& platform, unsigned& checkedVersion) const {
+    // if going down
+    if (velocityY < 0) {
+        // did we intersect a platform ? (the first one added, if several)
+        int landing = -1;
+        edgesIndex.query(glm::min(previous.x, feet.x), glm::max(previous.x, feet.x),
+            [this, &previous, &feet, &landing] (int i) -> void {
+            if (!isActive(i) || (landing >= 0 && landing < i))
+                return;
+            if (IntersectionUtil::lineLine(previous, feet, platforms[i].right, platforms[i].left, 0)) {
+                landing = i;
+            }
+        });
+        if (landing >= 0) {
+            standing = true;
+            platform = landing;
+            checkedVersion = version;
+            return PlatformerEvent::Landed;
+        }
+    } else if (velocityY == 0) {
+        if (standing) {
+            PlatformerEvent::Enum event = PlatformerEvent::None;
+            if (platform < 0 || !supports(platform, feet)) {
+                const int current = platform;
+                bool foundNew = false;
+                edgesIndex.query(feet.x, feet.x, [this, current, &feet, &platform, &foundNew] (int i) -> void {
+                    if (i == current || !isActive(i))
+                        return;
+                    if (supports(i, feet)) {
+                        platform = i;
+                        foundNew = true;
+                    }
+                });
+                if (!foundNew) {
+                    standing = false;
+                    platform = -1;
+                    event = PlatformerEvent::Fell;
+                }
+            } else if (checkedVersion != version && !isActive(platform)) {
+                // a platform was toggled since last check
+                standing = false;
+                platform = -1;
+                event = PlatformerEvent::Fell;
+            }
+            checkedVersion = version;
+            return event;
+        }
+    } else {
+        standing = false;
+        platform = -1;
+    }
+    return PlatformerEvent::None;
+}
+
+bool PlatformEdges::supports(int i, const glm::vec2& feet) const {
+    const float yEpsilon = 0.5;
+    return IntersectionUtil::lineLine(feet + glm::vec2(0, yEpsilon), feet - glm::vec2(0, yEpsilon),
+        platforms[i].right, platforms[i].left, 0);
+}
+
+}
@@ -0,0 +1,264 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "util/IntersectionUtil.h"
+
+#include "CoinSweep.h"
+#include "SweepAndPrune.h"
+#include "IntervalTree.h"
+#include "JumpTrackArena.h"
+
+/*
+ * Game rules, on plain data: GameScene, RunnerSystem and PlatformerSystem apply them to
+ * entities, SessionSimulator to its own arrays, so a simulated session plays exactly like
+ * an in-game one. Runner state is accessed by name: RunnerComponent and SimRunner both
+ * have coins, pickedCoins, coinCursor, coinSequenceBonus, oldNessBonus, totalCoinsEarned,
+ * currentJump, finished and ghost.
+ */
+namespace RunnerRules {
+    // rectangle in world coordinates (collision zone, coin, platform or switch)
+    struct Box {
+        Box(const glm::vec2& pPosition = glm::vec2(0.0f), const glm::vec2& pSize = glm::vec2(0.0f), float pRotation = 0) :
+            position(pPosition), size(pSize), rotation(pRotation) {}
+        glm::vec2 position, size;
+        float rotation;
+    };
+
+    inline bool intersect(const Box& a, const Box& b) {
+        return IntersectionUtil::rectangleRectangle(a.position, a.size, a.rotation, b.position, b.size, b.rotation);
+    }
+
+    ///--------------------- JUMPS ------------------------------------------------//
+    // value of jumpingSince once a jump started
+    const float JumpStarted = 0.001;
+
+    // Touch input of the current runner: a new touch starts a jump, if it stands on
+    // something, and holding lengthens the last one. Returns true if the jump track changed.
+    bool jumpInput(JumpTrackArena& jumps, int track, bool wasTouching,
+        float elapsed, float jumpingSince, float velocityY, float dt);
+
+    // Jump timers of a runner with a jump left in its track (runTime is the time since
+    // it started running). Returns a RunnerEvent mask: JumpStart (impulse and hold gravity),
+    // JumpEnd (fall gravity and next jump), or None - the jump force is held while jumpingSince > 0.
+    int advanceJump(float runTime, float jumpTime, float jumpDuration, float& jumpingSince, float dt);
+
+    // end of a run: the runner becomes a ghost, and starts again with its jumps
+    template<typename Runner>
+    void finishRun(Runner& rc) {
+        rc.finished = true;
+        rc.oldNessBonus++;
+        rc.coinSequenceBonus = 1;
+        rc.ghost = true;
+        rc.currentJump = 0;
+        rc.totalCoinsEarned = rc.coins.size();
+        rc.coins.clear();
+        std::fill(rc.pickedCoins.begin(), rc.pickedCoins.end(), 0);
+        rc.coinCursor = -1;
+    }
+
+    ///--------------------- COINS ------------------------------------------------//
+    inline int coinGain(int oldNessBonus, int coinSequenceBonus) {
+        return 10 * pow(2.0f, oldNessBonus) * coinSequenceBonus;
+    }
+
+    // Picks the coins (sorted left to right, of coinSize) touched by zone, in running
+    // direction as coin sequences are, and updates maxBonus (see Statistics). onPick(coin
+    // index, gain) is called for each of them, once the runner sequence bonus is updated
+    // (> 1 if the coin extends a sequence).
+    template<typename Runner, typename OnPick>
+    void pickCoins(Runner& rc, bool leftToRight, const Box& zone, const std::vector<glm::vec2>& coins,
+        const glm::vec2& coinSize, int& maxBonus, const OnPick& onPick) {
+        const int end = coins.size();
+        if (end == 0)
+            return;
+        // coins only partly cover their entity
+        const glm::vec2 size = coinSize * glm::vec2(0.5, 0.6);
+        const float reach = CoinSweep::halfExtentX(zone.size, zone.rotation) + glm::length(size) * 0.5f;
+
+        int first, last;
+        CoinSweep::window([&coins] (int i) -> float { return coins[i].x; }, end,
+            zone.position.x - reach, zone.position.x + reach, rc.coinCursor, first, last);
+
+        for (int i=first; i<last; i++) {
+            const int idx = leftToRight ? i : (first + last - i - 1);
+            const int prev = leftToRight ? idx - 1 : (idx + 1 < end ? idx + 1 : -1);
+            if (CoinSweep::isPicked(rc.pickedCoins, idx))
+                continue;
+            if (!IntersectionUtil::rectangleRectangle(zone.position, zone.size, zone.rotation, coins[idx], size, 0))
+                continue;
+            if (!rc.coins.empty()) {
+                if (rc.coins.back() == prev) {
+                    rc.coinSequenceBonus++;
+                    maxBonus = glm::max(maxBonus, rc.coinSequenceBonus);
+                } else {
+                    rc.coinSequenceBonus = 1;
+                }
+            }
+            rc.coins.push_back(idx);
+            CoinSweep::pick(rc.pickedCoins, idx);
+            onPick(idx, coinGain(rc.oldNessBonus, rc.coinSequenceBonus));
+        }
+    }
+
+    ///--------------------- KILLS ------------------------------------------------//
+    // A removed (killed) runner takes one oldness level away from older runners
+    inline int oldNessAfterKill(int oldNessBonus, int killedOldNessBonus) {
+        return (killedOldNessBonus < oldNessBonus) ? oldNessBonus - 1 : oldNessBonus;
+    }
+
+    // Runner-runner collisions of a step: ghosts can only be hit by active runners going
+    // the other way (ghosts going right against active runners going left, and the other
+    // way round). Buffers are kept from one step to the next.
+    class KillSweep {
+        public:
+            void clear() {
+                entries.clear();
+                sweep[0].clear();
+                sweep[1].clear();
+            }
+
+            // killed runners must not be added; recently restarted ghosts are ignored
+            void add(int id, const Box& zone, bool ghost, float elapsed, bool leftToRight);
+
+            // calls kill(id) once for each ghost touched
+            template<typename F>
+            void find(const F& kill) {
+                for (int d=0; d<2; d++) {
+                    sweep[d].findPairs([this, &kill] (int g, int a) -> void {
+                        Entry& ghost = entries[g];
+                        if (ghost.killed || !intersect(ghost.zone, entries[a].zone))
+                            return;
+                        ghost.killed = true;
+                        kill(ghost.id);
+                    });
+                }
+            }
+
+        private:
+            struct Entry {
+                int id;
+                Box zone;
+                bool killed;
+            };
+            std::vector<Entry> entries;
+            // by ghosts direction
+            SweepAndPrune sweep[2];
+    };
+
+    ///--------------------- PLATFORMS --------------------------------------------//
+    // Level3 platform (center x, top y, width) and its switches, hanging under both ends
+    Box platformBox(const glm::vec3& platform, float height);
+    Box switchBox(const glm::vec3& platform, int end, float platformHeight, const glm::vec2& switchSize);
+
+    // a platform is active while the same runner owns both its switches
+    template<typename Platform>
+    bool switchesOn(const Platform& pt) {
+        return pt.switches[0].state && pt.switches[1].state && pt.switches[1].owner == pt.switches[0].owner;
+    }
+
+    namespace PlatformerEvent {
+        enum Enum {
+            None,
+            Landed,
+            Fell
+        };
+    }
+
+    /*
+     * Platforms runners can land on: their top edges are looked up through an interval
+     * tree on x, rebuilt by update() when a platform was added or moved.
+     */
+    class PlatformEdges {
+        public:
+            PlatformEdges() : version(1), dirty(false) {}
+
+            void clear();
+            // returns index of the new platform
+            int add(const Box& platform, bool active);
+            // only recomputes the edge if the box changed
+            void move(int i, const Box& platform);
+            unsigned count() const { return platforms.size(); }
+            const Box& box(int i) const { return platforms[i].box; }
+
+            // changing it bumps the platforms version
+            void setActive(int i, bool active);
+            bool isActive(int i) const { return (activePlatforms[i >> 5] >> (i & 31)) & 1; }
+            unsigned getVersion() const { return version; }
+
+            // to be called after add/move, before any step
+            void update();
+
+            // One step of a platformer, its feet going from previous to feet.
+            // standing/platform: whether it stands on a platform, and which (-1 if unknown);
+            // checkedVersion: platforms version its platform was last checked against.
+            // Landed runners are moved to box(platform) center y, and stop falling;
+            // runners walking off their platform (or on a deactivated one) Fell.
+            PlatformerEvent::Enum step(float velocityY, const glm::vec2& previous, const glm::vec2& feet,
+                bool& standing, int& platform, unsigned& checkedVersion) const;
+
+        private:
+            bool supports(int i, const glm::vec2& feet) const;
+
+            struct Edge {
+                Box box;
+                glm::vec2 left, right;
+            };
+            std::vector<Edge> platforms;
+            // bit i is set if platforms[i] is active
+            std::vector<uint32_t> activePlatforms;
+            unsigned version;
+            IntervalTree edgesIndex;
+            bool dirty;
+    };
+
+    // Switches of Level3 platforms: switch id is platform * 2 + end
+    class SwitchIndex {
+        public:
+            void clear() { index.clear(); switches.clear(); }
+            void add(const Box& sw) {
+                const float extent = CoinSweep::halfExtentX(sw.size, sw.rotation);
+                index.add(sw.position.x - extent, sw.position.x + extent, switches.size());
+                switches.push_back(sw);
+            }
+            // switches don't move: to be called once they're added
+            void build() { index.build(); }
+
+            // calls f(platform, end) for each switch touched by zone
+            template<typename F>
+            void touch(const Box& zone, const F& f) const {
+                const float extent = CoinSweep::halfExtentX(zone.size, zone.rotation);
+                index.query(zone.position.x - extent, zone.position.x + extent, [this, &zone, &f] (int id) -> void {
+                    if (intersect(zone, switches[id]))
+                        f(id / 2, id % 2);
+                });
+            }
+
+        private:
+            IntervalTree index;
+            std::vector<Box> switches;
+    };
+}
@@ -0,0 +1,113 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SessionBatch.h"
+
+#include "base/Log.h"
+
+SessionBatch::SessionBatch(unsigned workerCount) : job(0), jobCount(0), nextJob(0), busyWorkers(0), generation(0), quit(false) {
+#if SAC_EMSCRIPTEN
+    // no threads there
+    workerCount = 1;
+#else
+    if (workerCount == 0) {
+        workerCount = glm::max(1u, std::thread::hardware_concurrency());
+    }
+#endif
+    // calling thread is the first worker
+    for (unsigned i=1; i<workerCount; i++) {
+        workers.push_back(std::thread(&SessionBatch::workerLoop, this));
+    }
+    LOGI("SessionBatch uses " << threadCount() << " threads");
+}
+
+SessionBatch::~SessionBatch() {
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        quit = true;
+    }
+    wakeUp.notify_all();
+    for (auto& w: workers) {
+        w.join();
+    }
+}
+
+void SessionBatch::step(std::vector<SessionSimulator>& sessions, float dt, const SessionSimulator::Controller& controller) {
+    run(sessions.size(), [&sessions, dt, &controller] (unsigned i) -> void {
+        sessions[i].step(dt, controller(sessions[i]));
+    });
+}
+
+void SessionBatch::play(std::vector<SessionSimulator>& sessions, float dt, const SessionSimulator::Controller& controller) {
+    run(sessions.size(), [&sessions, dt, &controller] (unsigned i) -> void {
+        sessions[i].play(dt, controller);
+    });
+}
+
+void SessionBatch::run(unsigned count, const std::function<void (unsigned)>& pJob) {
+    if (workers.empty()) {
+        for (unsigned i=0; i<count; i++) {
+            pJob(i);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        job = &pJob;
+        jobCount = count;
+        nextJob = 0;
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    consume();
+
+    std::unique_lock<std::mutex> l(mutex);
+    done.wait(l, [this] () -> bool { return busyWorkers == 0; });
+    job = 0;
+}
+
+void SessionBatch::consume() {
+    for (unsigned i = nextJob++; i < jobCount; i = nextJob++) {
+        (*job)(i);
+    }
+}
+
+void SessionBatch::workerLoop() {
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            wakeUp.wait(l, [this, seen] () -> bool { return quit || generation != seen; });
+            if (quit)
+                return;
+            seen = generation;
+        }
+
+        consume();
+
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            if (--busyWorkers == 0)
+                done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "SessionSimulator.h"
+
+/*
+ * Steps many independent SessionSimulator in parallel, on a pool of worker threads.
+ * The calling thread takes part in the work. The controller is called concurrently
+ * (for different sessions) so it must not have shared mutable state.
+ */
+class SessionBatch {
+    public:
+        // workerCount = 0 means one thread per core
+        SessionBatch(unsigned workerCount = 0);
+        ~SessionBatch();
+
+        unsigned threadCount() const { return workers.size() + 1; }
+
+        // lock-step mode: advance every session by one step
+        void step(std::vector<SessionSimulator>& sessions, float dt, const SessionSimulator::Controller& controller);
+
+        // play every session until its end, sessions being spread over the threads
+        void play(std::vector<SessionSimulator>& sessions, float dt, const SessionSimulator::Controller& controller);
+
+    private:
+        void run(unsigned count, const std::function<void (unsigned)>& job);
+        void consume();
+        void workerLoop();
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wakeUp, done;
+
+        const std::function<void (unsigned)>* job;
+        unsigned jobCount;
+        std::atomic<unsigned> nextJob;
+        unsigned busyWorkers, generation;
+        bool quit;
+};
@@ -0,0 +1,90 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * Random sequence owned by a session, so several sessions can run side by side
+ * (and on different threads) without sharing util/Random global state.
+ * Conversions are done by hand so a seed gives the same values on every platform.
+ *
+ * The engine is MT19937 (same sequence as std::mt19937), written out so its state can be
+ * saved with the session (see SessionSystem).
+ */
+class SessionRandom {
+    public:
+        static const unsigned StateSize = 624;
+
+        SessionRandom(uint32_t seed = 0) { init(seed); }
+
+        void init(uint32_t seed) {
+            state.resize(StateSize);
+            state[0] = seed;
+            for (unsigned i=1; i<StateSize; i++) {
+                state[i] = 1812433253u * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
+            }
+            index = StateSize;
+        }
+
+        // in [min, max)
+        float Float(float min, float max) {
+            return min + (max - min) * ((next() >> 8) * (1.0f / 16777216.0f));
+        }
+
+        // in [min, max]
+        int Int(int min, int max) {
+            return min + (int)(next() % (uint32_t)(max - min + 1));
+        }
+
+        void N_Floats(int count, float* out, float min, float max) {
+            for (int i=0; i<count; i++) {
+                out[i] = Float(min, max);
+            }
+        }
+
+    private:
+        uint32_t next() {
+            // restored from an invalid save: start over
+            if (state.size() != StateSize)
+                init(0);
+            if (index >= StateSize)
+                twist();
+            uint32_t y = state[index++];
+            y ^= y >> 11;
+            y ^= (y << 7) & 0x9d2c5680u;
+            y ^= (y << 15) & 0xefc60000u;
+            return y ^ (y >> 18);
+        }
+
+        void twist() {
+            for (unsigned i=0; i<StateSize; i++) {
+                const uint32_t y = (state[i] & 0x80000000u) | (state[(i + 1) % StateSize] & 0x7fffffffu);
+                state[i] = state[(i + 397) % StateSize] ^ (y >> 1) ^ ((y & 1) ? 0x9908b0dfu : 0);
+            }
+            index = 0;
+        }
+
+    public:
+        // raw data, public for serialization
+        std::vector<uint32_t> state;
+        uint32_t index;
+};
@@ -0,0 +1,411 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SessionSimulator.h"
+
+#include "base/Log.h"
+
+#include "CollisionZone.h"
+#include "../Parameters.h"
+
+#include <algorithm>
+#include <cmath>
+
+// PlacementHelper conversions, for a 1280x800 gimp size
+static glm::vec2 gimpSizeToScreen(const glm::vec2& size, const glm::vec2& screenSize) {
+    return size / glm::vec2(1280, 800) * screenSize;
+}
+
+static float gimpYToScreen(float y, const glm::vec2& screenSize) {
+    return -(y / 800 - 0.5f) * screenSize.y;
+}
+
+SimulationConfig::SimulationConfig(const glm::vec2& screenSize) {
+    levelWidth = param::LevelSize * screenSize.x;
+    baseLine = gimpYToScreen(800, screenSize);
+    // ingame/runner.entity, scaled in addRunnerToPlayer
+    runnerSize = gimpSizeToScreen(glm::vec2(200, 210), screenSize) * .68f;
+    // ingame/coin.entity, scaled in createCoins
+    coinSize = gimpSizeToScreen(glm::vec2(99, 107), screenSize) * param::CoinScale;
+    coinHeightMin = gimpYToScreen(700, screenSize);
+    coinHeightMax = gimpYToScreen(450, screenSize);
+    chunkWidth = screenSize.x;
+    coinsPerChunk = param::CoinsPerChunk;
+    runnerCount = param::runner;
+    // see RecursiveRunnerGame::startGame
+    platformHeight = gimpSizeToScreen(glm::vec2(100, 20), screenSize).y;
+    platformHeightMin = gimpYToScreen(680, screenSize);
+    platformHeightMax = gimpYToScreen(380, screenSize);
+    switchSize = gimpSizeToScreen(glm::vec2(30, 30), screenSize);
+}
+
+LevelLayout SimulationConfig::layout() const {
+    return LevelLayout(-levelWidth * 0.5, chunkWidth, (int)(levelWidth / chunkWidth + 0.5f), coinsPerChunk,
+        coinHeightMin, coinHeightMax);
+}
+
+SimRunner::SimRunner() : startX(0),
+    currentJump(0), oldNessBonus(0), coinSequenceBonus(1), totalCoinsEarned(0), index(-1),
+    finished(false), ghost(false), killed(false), jumpTrack(-1), coinCursor(-1),
+    animation(SimAnimation::Run), animationAccum(0), animationFrame(0),
+    previousFeet(0.0f), onPlatform(false), platform(-1), platformsVersion(0) {
+}
+
+// Runner animations, as described in assets/anim/*.anim
+static const struct {
+    float speed;
+    int frameCount;
+    bool loop;
+    SimAnimation::Enum next;
+    // jump_l2r_XXXX (run_l2r_XXXX for runL2R) texture of each frame
+    int textures[12];
+} animations[SimAnimation::Count] = {
+    { 15, 12, true, SimAnimation::Count, { 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 1 } }, // runL2R
+    { 20, 5, false, SimAnimation::Count, { 4, 5, 6, 7, 8 } },        // jumpL2R_up
+    { 15, 3, false, SimAnimation::Count, { 9, 10, 11 } },            // jumpL2R_down
+    { 30, 4, false, SimAnimation::Run, { 12, 13, 15, 16 } },         // jumptorunL2R
+};
+// see ingame/runner.entity
+static const float RunnerPlaybackSpeed = 1.1;
+
+static void setAnimation(SimRunner& rc, SimAnimation::Enum anim) {
+    if (rc.animation != anim) {
+        rc.animation = anim;
+        rc.animationAccum = 0;
+        rc.animationFrame = 0;
+    }
+}
+
+SessionSimulator::SessionSimulator(const SimulationConfig& pConfig, const SessionSetup& setup) :
+    config(pConfig), coins(setup.coins), nextRunnerStartTime(setup.runnerStartTimes),
+    nextRunnerStartTimeIndex(0), current(-1), runnersCount(0), points(0), coinsCollected(0),
+    wasTouching(false), over(false) {
+    const int runnerCount = config.runnerCount ? config.runnerCount : param::EndlessPreallocatedRunners;
+    stats.reset(runnerCount);
+
+    // same order as session coins (see RecursiveRunnerGame::createCoins)
+    std::sort(coins.begin(), coins.end(), [] (const glm::vec2& a, const glm::vec2& b) -> bool {
+        return a.x < b.x;
+    });
+    runners.reserve(runnerCount);
+    kinematics.reserve(runnerCount);
+
+    // ground spans the level, and half a screen further on both sides (see GameScene)
+    platformEdges.add(RunnerRules::Box(glm::vec2(0, config.baseLine), glm::vec2(config.levelWidth + config.chunkWidth, 0)), true);
+    platforms.resize(setup.platforms.size());
+    for (unsigned i=0; i<setup.platforms.size(); i++) {
+        platformEdges.add(RunnerRules::platformBox(setup.platforms[i], config.platformHeight), false);
+        for (int l=0; l<2; l++) {
+            switchIndex.add(RunnerRules::switchBox(setup.platforms[i], l, config.platformHeight, config.switchSize));
+        }
+    }
+    platformEdges.update();
+    switchIndex.build();
+    // chunks are a screen wide
+    jumps.init(runnerCount, JumpTrackArena::jumpsPerTrackFor(config.layout().chunkCount));
+    addRunner();
+}
+
+void SessionSimulator::addRunner() {
+    const float direction = (runnersCount % 2) ? -1 : 1;
+    SimRunner rc;
+    rc.startX = direction * -(config.levelWidth + config.runnerSize.x) * 0.5;
+    rc.index = runnersCount;
+    stats.grow(runnersCount + 1);
+    rc.jumpTrack = jumps.createTrack();
+    rc.coins.reserve(coins.size());
+    CoinSweep::reset(rc.pickedCoins, coins.size());
+    runners.push_back(rc);
+
+    const unsigned i = kinematics.add(rc.startX, config.baseLine + config.runnerSize.y * 0.5,
+        direction * (param::speedConst + param::speedCoeff * runnersCount),
+        direction * (config.levelWidth + config.runnerSize.x) * 0.5);
+    runners[i].previousFeet = glm::vec2(kinematics.positionX[i], config.baseLine);
+    updateCollisionZone(i);
+
+    runnersCount++;
+    current = i;
+}
+
+void SessionSimulator::step(float dt, bool touching) {
+    if (over)
+        return;
+
+    // kills are credited to the runner active at the beginning of the frame (as in GameScene)
+    const int runnerIdx = runners[current].index;
+
+    if (runners[current].finished) {
+        const bool last = config.runnerCount ?
+            (runnersCount == config.runnerCount) :
+            (runners[current].totalCoinsEarned == 0);
+        if (last) {
+            over = true;
+            stats.score = points;
+            return;
+        }
+        addRunner();
+    }
+
+    handleInput(dt, touching);
+
+    handleKills(runnerIdx);
+
+    for (unsigned i=0; i<runners.size(); i++) {
+        SimRunner& rc = runners[i];
+        if (rc.killed)
+            continue;
+        checkCoinsPickup(i);
+        stats.runner[rc.index].lifetime += dt;
+        stats.runner[rc.index].maxOldness = glm::max(rc.oldNessBonus, stats.runner[rc.index].maxOldness);
+        checkSwitches(i);
+    }
+    updatePlatforms();
+
+    for (unsigned i=0; i<runners.size(); i++) {
+        if (!runners[i].killed)
+            updatePlatformer(i);
+    }
+
+    updateRunners(dt);
+
+    for (unsigned i=0; i<runners.size(); i++) {
+        if (runners[i].killed && kinematics.elapsed[i] >= 0)
+            removeKilledRunner(i);
+    }
+
+    kinematics.integrate(dt);
+    for (unsigned i=0; i<runners.size(); i++) {
+        if (runners[i].killed)
+            continue;
+        updateAnimation(runners[i], dt);
+        updateCollisionZone(i);
+    }
+}
+
+int SessionSimulator::play(float dt, const Controller& controller, unsigned maxSteps) {
+    for (unsigned i=0; i<maxSteps && !over; i++) {
+        step(dt, controller(*this));
+    }
+    return points;
+}
+
+void SessionSimulator::handleInput(float dt, bool touching) {
+    if (touching && RunnerRules::jumpInput(jumps, runners[current].jumpTrack, wasTouching,
+        kinematics.elapsed[current], kinematics.jumpingSince[current], kinematics.velocityY[current], dt)) {
+        refreshJump(current);
+    }
+    wasTouching = touching;
+}
+
+void SessionSimulator::handleKills(int runnerIdx) {
+    killSweep.clear();
+    for (unsigned i=0; i<runners.size(); i++) {
+        const SimRunner& rc = runners[i];
+        if (!rc.killed)
+            killSweep.add(i, rc.zone, rc.ghost, kinematics.elapsed[i], kinematics.speed[i] > 0);
+    }
+    killSweep.find([this, runnerIdx] (int i) -> void {
+        runners[i].killed = true;
+        kinematics.active[i] = 0;
+        stats.runner[runnerIdx].killed++;
+    });
+}
+
+void SessionSimulator::checkCoinsPickup(unsigned runner) {
+    SimRunner& rc = runners[runner];
+    const bool isCurrent = ((int)runner == current);
+    RunnerRules::pickCoins(rc, kinematics.speed[runner] > 0, rc.zone, coins, config.coinSize, stats.runner[rc.index].maxBonus,
+        [this, &rc, isCurrent] (int, int gain) -> void {
+        points += gain;
+        stats.runner[rc.index].pointScored += gain;
+        if (isCurrent) {
+            coinsCollected++;
+            stats.runner[rc.index].coinsCollected++;
+        }
+    });
+}
+
+void SessionSimulator::checkSwitches(unsigned i) {
+    switchIndex.touch(runners[i].zone, [this, i] (int k, int l) -> void {
+        platforms[k].switches[l].owner = i;
+        platforms[k].switches[l].state = true;
+    });
+}
+
+void SessionSimulator::updatePlatforms() {
+    for (unsigned i=0; i<platforms.size(); i++) {
+        SimPlatform& pt = platforms[i];
+        const bool active = RunnerRules::switchesOn(pt);
+        if (active != pt.active) {
+            pt.active = active;
+            platformEdges.setActive(i + 1, active);
+        }
+    }
+}
+
+void SessionSimulator::updatePlatformer(unsigned i) {
+    SimRunner& rc = runners[i];
+    const float offset = config.runnerSize.y * -0.5;
+    glm::vec2 feet(kinematics.positionX[i], kinematics.positionY[i] + offset);
+
+    switch (platformEdges.step(kinematics.velocityY[i], rc.previousFeet, feet, rc.onPlatform, rc.platform, rc.platformsVersion)) {
+        case RunnerRules::PlatformerEvent::Landed:
+            kinematics.gravity[i] = 0;
+            kinematics.velocityY[i] = 0;
+            kinematics.positionY[i] = platformEdges.box(rc.platform).position.y + config.runnerSize.y * 0.5;
+            setAnimation(rc, SimAnimation::JumpToRun);
+            feet.y = kinematics.positionY[i] + offset;
+            break;
+        case RunnerRules::PlatformerEvent::Fell:
+            kinematics.gravity[i] = param::FallGravity;
+            break;
+        default:
+            break;
+    }
+    rc.previousFeet = feet;
+}
+
+void SessionSimulator::updateRunners(float dt) {
+    // vectorized pass, then rare events are handled one runner at a time
+    kinematics.advance(dt);
+
+    for (unsigned i=0; i<runners.size(); i++) {
+        SimRunner& rc = runners[i];
+        if (rc.killed)
+            continue;
+
+        int events = kinematics.events[i];
+        if (events & RunnerEvent::Finished) {
+            finishRunner(i);
+            events = kinematics.advanceJump(i, dt);
+        }
+        if (events & RunnerEvent::JumpStart) {
+            setAnimation(rc, SimAnimation::JumpUp);
+        }
+        if (events & RunnerEvent::JumpEnd) {
+            rc.currentJump++;
+            refreshJump(i);
+        }
+        if (kinematics.gravity[i] < 0 && kinematics.velocityY[i] < -10) {
+            setAnimation(rc, SimAnimation::JumpDown);
+        }
+    }
+}
+
+void SessionSimulator::finishRunner(unsigned i) {
+    SimRunner& rc = runners[i];
+    setAnimation(rc, SimAnimation::Run);
+    RunnerRules::finishRun(rc);
+    if (nextRunnerStartTimeIndex >= nextRunnerStartTime.size()) {
+        // endless sessions outlive their setup: start times are used again
+        LOGF_IF(config.runnerCount || nextRunnerStartTime.empty(), "Not enough start times");
+        nextRunnerStartTimeIndex = 0;
+    }
+    kinematics.startTime[i] = nextRunnerStartTime[nextRunnerStartTimeIndex++];
+    kinematics.positionX[i] = rc.startX;
+    kinematics.positionY[i] = config.baseLine + config.runnerSize.y * 0.5;
+    kinematics.elapsed[i] = kinematics.jumpingSince[i] = 0;
+    refreshJump(i);
+
+    kinematics.velocityY[i] = 0;
+    kinematics.gravity[i] = 0;
+}
+
+void SessionSimulator::refreshJump(unsigned i) {
+    const SimRunner& rc = runners[i];
+    if (rc.currentJump < jumps.size(rc.jumpTrack))
+        kinematics.setJump(i, jumps.time(rc.jumpTrack, rc.currentJump), jumps.duration(rc.jumpTrack, rc.currentJump));
+    else
+        kinematics.clearJump(i);
+}
+
+void SessionSimulator::removeKilledRunner(unsigned k) {
+    const SimRunner& killed = runners[k];
+    for (unsigned i=0; i<runners.size(); i++) {
+        SimRunner& rc = runners[i];
+        if (i == k || (rc.killed && kinematics.elapsed[i] < 0))
+            continue;
+        rc.oldNessBonus = RunnerRules::oldNessAfterKill(rc.oldNessBonus, killed.oldNessBonus);
+    }
+    kinematics.elapsed[k] = -1;
+}
+
+void SessionSimulator::updateAnimation(SimRunner& rc, float dt) {
+    rc.animationAccum += dt * animations[rc.animation].speed * RunnerPlaybackSpeed;
+    while (rc.animationAccum >= 1) {
+        rc.animationAccum -= 1;
+        if (rc.animationFrame + 1 < animations[rc.animation].frameCount) {
+            rc.animationFrame++;
+        } else if (animations[rc.animation].loop) {
+            rc.animationFrame = 0;
+        } else {
+            if (animations[rc.animation].next != SimAnimation::Count)
+                setAnimation(rc, animations[rc.animation].next);
+            else
+                rc.animationAccum = 0;
+            break;
+        }
+    }
+}
+
+void SessionSimulator::updateCollisionZone(unsigned i) {
+    SimRunner& rc = runners[i];
+    // runners going right to left are mirrored
+    const int texture = animations[rc.animation].textures[rc.animationFrame];
+    const CollisionZone& cz = RunnerCollision::frame(
+        (rc.animation == SimAnimation::Run) ? RunnerCollision::runFrame(texture) : texture,
+        kinematics.speed[i] < 0);
+
+    rc.zone = RunnerRules::Box(glm::vec2(kinematics.positionX[i], kinematics.positionY[i]) + config.runnerSize * cz.position,
+        config.runnerSize * cz.size, cz.rotation);
+}
+
+// Level3 platforms are drawn from the seeded sequence, before start times
+static std::vector<glm::vec3> generatePlatforms(SessionRandom& random, const SimulationConfig& config) {
+    return LevelChunks::generatePlatforms(random, param::PlatformCount, param::PlatformRows,
+        config.platformHeightMin, config.platformHeightMax, config.levelWidth);
+}
+
+SessionSetup SessionSimulator::setupFromSeed(hash_t seed, const SimulationConfig& config, Level::Enum level) {
+    SessionSetup setup;
+
+    setup.coins = LevelChunks::generateCoins(seed, config.layout());
+    // Level2 behaviour: start times come from the seeded sequence
+    SessionRandom random(seed);
+    if (level == Level::Level3) {
+        setup.platforms = generatePlatforms(random, config);
+    }
+    setup.runnerStartTimes.resize(100);
+    for (unsigned i=0; i<setup.runnerStartTimes.size(); i++) {
+        setup.runnerStartTimes[i] = Replay::quantize(random.Float(0.0f, 2.0f));
+    }
+    return setup;
+}
+
+SessionSetup SessionSimulator::setupFromReplay(const ReplayData& replay, const SimulationConfig& config) {
+    SessionSetup setup;
+
+    setup.coins = LevelChunks::generateCoins(replay.seed, config.layout());
+    if (replay.level == Level::Level3) {
+        SessionRandom random(replay.seed);
+        setup.platforms = generatePlatforms(random, config);
+    }
+    setup.runnerStartTimes = replay.runnerStartTimes;
+    return setup;
+}
@@ -0,0 +1,189 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <glm/glm.hpp>
+
+#include "base/Entity.h"
+#include "systems/SessionSystem.h"
+
+#include "SessionRandom.h"
+#include "RunnerKinematics.h"
+#include "JumpTrackArena.h"
+#include "Replay.h"
+#include "RunnerRules.h"
+#include "LevelChunks.h"
+#include "../Level.h"
+
+/*
+ * Render-free replica of a game session.
+ * It applies the same rules (see RunnerRules) as GameScene, RunnerSystem and PlatformerSystem:
+ * jumps recording and ghost replay, coins pickup, runner-runner kills, Level3 platforms and
+ * switches, scoring; on plain data: no entity is created and no Rendering/Text/Music/Animation
+ * system is needed. Used for bots evaluation and offline score checks.
+ */
+
+struct SimulationConfig {
+    // default metrics are the in-game ones (see PlacementHelper::ScreenSize)
+    SimulationConfig(const glm::vec2& screenSize = glm::vec2(20, 12.5));
+
+    float levelWidth, baseLine;
+    glm::vec2 runnerSize, coinSize;
+    float coinHeightMin, coinHeightMax;
+    // level is levelWidth / chunkWidth chunks (see LevelChunks)
+    float chunkWidth;
+    int coinsPerChunk;
+    // 0 for endless sessions, which end when a runner completes a run without any coin
+    int runnerCount;
+    // Level3 platforms (ingame/platform.entity) and switches (ingame/switch.entity)
+    float platformHeight, platformHeightMin, platformHeightMax;
+    glm::vec2 switchSize;
+
+    // same as RecursiveRunnerGame::levelLayout
+    LevelLayout layout() const;
+};
+
+// everything needed to replay a session: coins layout, Level3 platforms (see
+// LevelChunks::generatePlatforms) and ghosts restart delays
+struct SessionSetup {
+    std::vector<glm::vec2> coins;
+    std::vector<glm::vec3> platforms;
+    std::vector<float> runnerStartTimes;
+};
+
+namespace SimAnimation {
+    enum Enum {
+        Run,
+        JumpUp,
+        JumpDown,
+        JumpToRun,
+        Count
+    };
+}
+
+// cold runner data; per-frame data is in RunnerKinematics, at the same index
+struct SimRunner {
+    SimRunner();
+
+    float startX;
+    int currentJump, oldNessBonus, coinSequenceBonus, totalCoinsEarned;
+    int index;
+    bool finished, ghost, killed;
+    // track in SessionSimulator jumps
+    int jumpTrack;
+    // indices of picked coins, in pickup order, and as a bitset
+    std::vector<int> coins;
+    std::vector<uint32_t> pickedCoins;
+    // see CoinSweep::window
+    int coinCursor;
+
+    SimAnimation::Enum animation;
+    float animationAccum;
+    int animationFrame;
+
+    // collision zone in world coordinates
+    RunnerRules::Box zone;
+    // see PlatformerComponent: feet at the previous step, and platform they stand on
+    glm::vec2 previousFeet;
+    bool onPlatform;
+    int platform;
+    unsigned platformsVersion;
+};
+
+// same as Platform, switch owners being runner indices
+struct SimPlatform {
+    SimPlatform() : active(false) {
+        switches[0].owner = switches[1].owner = -1;
+        switches[0].state = switches[1].state = false;
+    }
+    struct {
+        int owner;
+        bool state;
+    } switches[2];
+    bool active;
+};
+
+class SessionSimulator {
+    public:
+        // return true if the player is touching the screen
+        typedef std::function<bool (const SessionSimulator&)> Controller;
+
+        SessionSimulator(const SimulationConfig& config, const SessionSetup& setup);
+
+        void step(float dt, bool touching);
+
+        // play until the end of the session (or maxSteps), returns final points
+        int play(float dt, const Controller& controller, unsigned maxSteps = 1000000);
+
+        bool isOver() const { return over; }
+        int getPoints() const { return points; }
+        int getCoinsCollected() const { return coinsCollected; }
+        const Statistics& getStatistics() const { return stats; }
+        const std::vector<SimRunner>& getRunners() const { return runners; }
+        const SimRunner& getCurrentRunner() const { return runners[current]; }
+        int getCurrentRunnerIndex() const { return current; }
+        const RunnerKinematics& getKinematics() const { return kinematics; }
+        const JumpTrackArena& getJumps() const { return jumps; }
+        const std::vector<glm::vec2>& getCoins() const { return coins; }
+        const std::vector<SimPlatform>& getPlatforms() const { return platforms; }
+
+        // same coins, platforms and start times as RecursiveRunnerGame::startGame for this seed
+        // (Level3 start times aren't seeded in game: they're drawn after the platforms here)
+        static SessionSetup setupFromSeed(hash_t seed, const SimulationConfig& config, Level::Enum level = Level::Level2);
+        // coins and platforms of the replay seed, and its recorded start times
+        static SessionSetup setupFromReplay(const ReplayData& replay, const SimulationConfig& config);
+
+    private:
+        void addRunner();
+        void handleInput(float dt, bool touching);
+        void handleKills(int runnerIdx);
+        void checkCoinsPickup(unsigned i);
+        void checkSwitches(unsigned i);
+        void updatePlatforms();
+        void updatePlatformer(unsigned i);
+        void updateRunners(float dt);
+        void finishRunner(unsigned i);
+        void refreshJump(unsigned i);
+        void removeKilledRunner(unsigned i);
+        void updateAnimation(SimRunner& rc, float dt);
+        void updateCollisionZone(unsigned i);
+
+    private:
+        SimulationConfig config;
+        std::vector<glm::vec2> coins;
+        std::vector<float> nextRunnerStartTime;
+        unsigned nextRunnerStartTimeIndex;
+
+        std::vector<SimRunner> runners;
+        RunnerKinematics kinematics;
+        JumpTrackArena jumps;
+        RunnerRules::KillSweep killSweep;
+        // Level3 platforms: edge of platform i is i + 1, the first edge being the ground
+        std::vector<SimPlatform> platforms;
+        RunnerRules::PlatformEdges platformEdges;
+        RunnerRules::SwitchIndex switchIndex;
+        int current;
+        int runnersCount;
+        int points, coinsCollected;
+        bool wasTouching, over;
+        Statistics stats;
+};
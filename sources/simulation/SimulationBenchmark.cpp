@@ -0,0 +1,201 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SimulationBenchmark.h"
+
+#include "RunnerKinematics.h"
+#include "LevelChunks.h"
+#include "SessionRandom.h"
+#include "SessionSimulator.h"
+#include "SessionBatch.h"
+#include "StatsLog.h"
+#include "systems/SessionSystem.h"
+#include "../Parameters.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// ground and level bounds, as in SimulationConfig
+static const float BaseLine = -6.25;
+static const float HalfLevel = 10 * param::LevelSize;
+
+static void addGhosts(RunnerKinematics& k, int count) {
+    SessionRandom random(count);
+
+    k.reserve(count);
+    for (int i=0; i<count; i++) {
+        const float direction = (i % 2) ? -1 : 1;
+        const unsigned r = k.add(-direction * HalfLevel, BaseLine, direction * param::speedConst, direction * HalfLevel);
+        k.startTime[r] = random.Float(0, 2);
+        k.setJump(r, random.Float(0, 1), random.Float(param::MinJumpDuration, param::MaxJumpDuration));
+    }
+}
+
+// what SessionSimulator does around the kernels: restart at the end, next jump, landing
+static void handleEvents(RunnerKinematics& k, float dt) {
+    for (unsigned i=0; i<k.size(); i++) {
+        if (k.events[i] & RunnerEvent::Finished) {
+            k.positionX[i] = -k.endX[i];
+            k.elapsed[i] = k.jumpingSince[i] = 0;
+            k.advanceJump(i, dt);
+        } else if (k.events[i] & RunnerEvent::JumpEnd) {
+            k.setJump(i, k.jumpTime[i] + 1.3, k.jumpDuration[i]);
+        }
+        if (k.velocityY[i] < 0 && k.positionY[i] <= BaseLine) {
+            k.positionY[i] = BaseLine;
+            k.velocityY[i] = k.gravity[i] = 0;
+        }
+    }
+}
+
+template<class Frame>
+static double microsecondsPerFrame(int frames, Frame frame) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i=0; i<frames; i++) {
+        frame();
+    }
+    std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - begin;
+    return d.count() / frames;
+}
+
+void SimulationBenchmark::runnerKinematics() {
+    const float dt = 1.0f / 60;
+    const int frames = 5000;
+
+    for (int count: { 10, 100, 1000 }) {
+        RunnerKinematics vectorized, scalar;
+        addGhosts(vectorized, count);
+        addGhosts(scalar, count);
+
+        const double v = microsecondsPerFrame(frames, [&vectorized, dt] () -> void {
+            vectorized.advance(dt);
+            handleEvents(vectorized, dt);
+            vectorized.integrate(dt);
+        });
+        const double s = microsecondsPerFrame(frames, [&scalar, dt] () -> void {
+            scalar.advanceScalar(dt);
+            handleEvents(scalar, dt);
+            scalar.integrateScalar(dt);
+        });
+        std::cout << "RunnerKinematics " << count << " ghosts: " << v << " us/frame (scalar: " << s << " us/frame)" << std::endl;
+    }
+}
+
+void SimulationBenchmark::coinPlacement() {
+    for (int count: { 20, 1000, 10000, 100000 }) {
+        // as dense as level chunks: 1 apart, in twice the packed width
+        std::vector<glm::vec2> coins(count);
+        SessionRandom random(count);
+        const int runs = glm::max(1, 1000000 / count);
+
+        const double us = microsecondsPerFrame(runs, [&coins, &random, count] () -> void {
+            LevelChunks::placeCoins(random, count, 0, 2 * count, 1, -2, 2, &coins[0]);
+        });
+        std::cout << "LevelChunks " << count << " coins: " << us << " us/placement" << std::endl;
+    }
+}
+
+void SimulationBenchmark::statsLog() {
+    const int games = 100000;
+    SessionRandom random(games);
+    StatsLogWriter writer;
+    Statistics stats;
+    for (int g=0; g<games; g++) {
+        stats.reset(param::runner);
+        stats.score = random.Int(0, 5000);
+        for (auto& r: stats.runner) {
+            r.coinsCollected = random.Int(0, 20);
+            r.lifetime = random.Float(0, 60);
+            r.pointScored = random.Int(0, 1000);
+            r.killed = random.Int(0, 3);
+            r.maxOldness = random.Int(0, 9);
+            r.maxBonus = random.Int(0, 10);
+        }
+        writer.add(stats, g % 3, 1400000000 + g * 60);
+    }
+
+    std::vector<uint8_t> log;
+    const double write = microsecondsPerFrame(1, [&writer, &log] () -> void {
+        writer.encode(log);
+    });
+    StatsLogReader reader;
+    reader.open(&log[0], log.size());
+
+    std::vector<int32_t> points, runners;
+    std::vector<double> means;
+    int32_t median = 0;
+    const double query = microsecondsPerFrame(1, [&] () -> void {
+        reader.column(StatsColumn::Points, points);
+        reader.column(StatsColumn::Runner, runners);
+        StatsLog::meanPerRunner(points, runners, means);
+        median = StatsLog::percentile(points, 0.5);
+    });
+    // the mean alone doesn't need whole columns: blocks are decoded one by one
+    std::vector<int32_t> blockPoints(StatsLog::BlockRows), blockRunners(StatsLog::BlockRows);
+    const double streamed = microsecondsPerFrame(1, [&] () -> void {
+        StatsLog::RunnerMeans m;
+        for (unsigned b=0; b<reader.blockCount(); b++) {
+            const unsigned count = reader.column(StatsColumn::Points, b, &blockPoints[0]);
+            reader.column(StatsColumn::Runner, b, &blockRunners[0]);
+            m.add(&blockPoints[0], &blockRunners[0], count);
+        }
+        m.means(means);
+    });
+    std::cout << "StatsLog " << reader.rowCount() << " rows: " << log.size() / reader.rowCount() << " bytes/row, write "
+        << write / 1000 << " ms, mean per runner + median " << query / 1000 << " ms (median: " << median
+        << "), streamed mean per runner " << streamed / 1000 << " ms" << std::endl;
+}
+
+void SimulationBenchmark::sessionBatch() {
+    const int sessionCount = 256;
+    const float dt = 1.0f / param::SimulationTickRate;
+    const SimulationConfig config;
+    // taps every 1.3 s of the current runner life: no state shared between sessions
+    const SessionSimulator::Controller controller = [] (const SessionSimulator& s) -> bool {
+        return fmod(s.getKinematics().elapsed[s.getCurrentRunnerIndex()], 1.3f) < 0.1f;
+    };
+
+    std::vector<SessionSimulator> sessions;
+    for (int i=0; i<sessionCount; i++) {
+        sessions.push_back(SessionSimulator(config, SessionSimulator::setupFromSeed(i, config)));
+    }
+    std::vector<SessionSimulator> batched(sessions);
+
+    const double single = microsecondsPerFrame(1, [&sessions, dt, &controller] () -> void {
+        for (auto& s: sessions) {
+            s.play(dt, controller);
+        }
+    });
+    SessionBatch batch;
+    const double parallel = microsecondsPerFrame(1, [&batch, &batched, dt, &controller] () -> void {
+        batch.play(batched, dt, controller);
+    });
+
+    long points = 0;
+    int mismatches = 0;
+    for (int i=0; i<sessionCount; i++) {
+        points += sessions[i].getPoints();
+        mismatches += (sessions[i].getPoints() != batched[i].getPoints());
+    }
+    std::cout << "SessionBatch " << sessionCount << " sessions: " << single / 1000 << " ms on 1 thread, "
+        << parallel / 1000 << " ms on " << batch.threadCount() << " threads (avg points: "
+        << points / sessionCount << ", " << mismatches << " mismatches)" << std::endl;
+}
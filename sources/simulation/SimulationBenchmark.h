@@ -0,0 +1,36 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/*
+ * Micro benchmarks of the simulation hot paths, printed on stdout.
+ * Only called in benchmark builds (see BENCHMARK_MODE cmake option).
+ */
+namespace SimulationBenchmark {
+    // per-frame cost of the RunnerKinematics kernel alone (RunnerSystem advances runners with
+    // it) for 10, 100 and 1000 ghosts, vectorized and scalar
+    void runnerKinematics();
+    // LevelChunks::placeCoins, from 20 to 100k coins
+    void coinPlacement();
+    // StatsLog writing, column decoding and aggregates, for 100k games
+    void statsLog();
+    // whole seeded sessions played by SessionSimulator, one after the other then by SessionBatch
+    void sessionBatch();
+}
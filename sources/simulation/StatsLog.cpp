@@ -0,0 +1,333 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "StatsLog.h"
+#include "Bytes.h"
+
+#include "base/Log.h"
+#include "systems/SessionSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+#if !defined(_WIN32) && !SAC_EMSCRIPTEN
+#define STATS_LOG_USE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const char Magic[4] = { 'R', 'R', 'S', 'B' };
+static const uint16_t Version = 2;
+static const unsigned HeaderSize = 20;
+static const unsigned TableSize = HeaderSize + 4 * StatsColumn::Count;
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+int32_t StatsLog::percentile(std::vector<int32_t>& values, float p) {
+    if (values.empty())
+        return 0;
+    const unsigned rank = std::min((unsigned)values.size() - 1,
+        (unsigned)std::max(0.0f, ceilf(p * values.size()) - 1));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+void StatsLog::meanPerRunner(const std::vector<int32_t>& values, const std::vector<int32_t>& runners, std::vector<double>& out) {
+    RunnerMeans m;
+    m.add(values.data(), runners.data(), std::min(values.size(), runners.size()));
+    m.means(out);
+}
+
+void StatsLog::RunnerMeans::add(const int32_t* values, const int32_t* runners, unsigned count) {
+    if (count == 0)
+        return;
+    const unsigned runnerCount = *std::max_element(runners, runners + count) + 1;
+    if (runnerCount > sums.size()) {
+        sums.resize(runnerCount, 0);
+        counts.resize(runnerCount, 0);
+    }
+    for (unsigned i=0; i<count; i++) {
+        sums[runners[i]] += values[i];
+        counts[runners[i]]++;
+    }
+}
+
+void StatsLog::RunnerMeans::means(std::vector<double>& out) const {
+    out.resize(sums.size());
+    for (unsigned i=0; i<sums.size(); i++) {
+        out[i] = counts[i] ? (double)sums[i] / counts[i] : 0;
+    }
+}
+
+// offset of the next magic after offset, size if there's none
+static unsigned nextMagic(const uint8_t* data, unsigned size, unsigned offset) {
+    for (unsigned i=offset + 1; i + 4 <= size; i++) {
+        if (!memcmp(data + i, Magic, 4))
+            return i;
+    }
+    return size;
+}
+
+StatsLogWriter::StatsLogWriter() : repaired(false) {
+}
+
+void StatsLogWriter::add(const Statistics& stats, int level, uint32_t time) {
+    for (unsigned i=0; i<stats.runner.size(); i++) {
+        const Statistics::Runner& r = stats.runner[i];
+        columns[StatsColumn::Time].push_back(time);
+        columns[StatsColumn::Level].push_back(level);
+        columns[StatsColumn::Score].push_back(stats.score);
+        columns[StatsColumn::Runner].push_back(i);
+        columns[StatsColumn::Coins].push_back(r.coinsCollected);
+        columns[StatsColumn::Lifetime].push_back((int32_t)floor(r.lifetime * StatsLog::LifetimeTicksPerSecond + 0.5f));
+        columns[StatsColumn::Points].push_back(r.pointScored);
+        columns[StatsColumn::Killed].push_back(r.killed);
+        columns[StatsColumn::Oldness].push_back(r.maxOldness);
+        columns[StatsColumn::Bonus].push_back(r.maxBonus);
+    }
+}
+
+void StatsLogWriter::encode(std::vector<uint8_t>& out) {
+    const unsigned total = pendingRows();
+    std::vector<uint8_t> payload;
+
+    for (unsigned first=0; first<total; first+=StatsLog::BlockRows) {
+        const unsigned count = std::min(StatsLog::BlockRows, total - first);
+        const unsigned header = out.size();
+        out.resize(header + TableSize);
+        memcpy(&out[header], Magic, 4);
+        Bytes::write16(&out[header + 4], Version);
+        Bytes::write16(&out[header + 6], StatsColumn::Count);
+        Bytes::write32(&out[header + 8], count);
+
+        for (int c=0; c<StatsColumn::Count; c++) {
+            payload.clear();
+            const int32_t* values = &columns[c][first];
+            int32_t previous = 0;
+            for (unsigned i=0; i<count; i++) {
+                Bytes::writeVarint(payload, zigzag(values[i] - previous));
+                previous = values[i];
+            }
+            Bytes::write32(&out[header + HeaderSize + 4 * c], payload.size());
+            out.insert(out.end(), payload.begin(), payload.end());
+        }
+        const unsigned blockSize = out.size() - header;
+        Bytes::write32(&out[header + 12], blockSize);
+        Bytes::write32(&out[header + 16], Bytes::checksum(&out[header + HeaderSize], blockSize - HeaderSize));
+    }
+
+    for (int c=0; c<StatsColumn::Count; c++) {
+        columns[c].clear();
+    }
+}
+
+bool StatsLogWriter::repair(const std::string& path) {
+    StatsLogReader reader;
+    reader.open(path);
+    if (reader.validSize() == reader.byteCount())
+        return true;
+
+    LOGW("Stats log '" << path << "' ends with " << (reader.byteCount() - reader.validSize()) << " invalid bytes, dropping them");
+    // written aside then renamed (same as ReplayArchiveWriter::save)
+    const std::string tmp = path + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (!file) {
+        LOGW("Unable to write stats log '" << tmp << "'");
+        return false;
+    }
+    bool ok = (reader.validSize() == 0 || fwrite(reader.bytes(), reader.validSize(), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        LOGW("Unable to repair stats log '" << path << "'");
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool StatsLogWriter::append(const std::string& path) {
+    if (pendingRows() == 0)
+        return true;
+    // blocks written after a torn one would be unreachable until the next resync
+    if (!repaired) {
+        if (!repair(path))
+            return false;
+        repaired = true;
+    }
+    std::vector<uint8_t> b;
+    encode(b);
+
+    FILE* file = fopen(path.c_str(), "ab");
+    if (!file) {
+        LOGW("Unable to write stats log '" << path << "'");
+        return false;
+    }
+    bool ok = (fwrite(&b[0], b.size(), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    // a partial write has to be dropped before the next append
+    repaired = ok;
+    return ok;
+}
+
+StatsLogReader::StatsLogReader() : data(0), size(0), rows(0), validEnd(0), mapped(false) {
+}
+
+StatsLogReader::~StatsLogReader() {
+    close();
+}
+
+// same as ReplayArchive::open
+bool StatsLogReader::open(const std::string& path) {
+    close();
+#if STATS_LOG_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(m);
+            size = st.st_size;
+            mapped = true;
+        }
+    }
+    ::close(fd);
+#else
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    buffer.resize(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    const bool ok = buffer.empty() || fread(&buffer[0], buffer.size(), 1, file) == 1;
+    fclose(file);
+    if (!ok) {
+        buffer.clear();
+        return false;
+    }
+    data = buffer.empty() ? 0 : &buffer[0];
+    size = buffer.size();
+#endif
+    return index();
+}
+
+bool StatsLogReader::open(const uint8_t* pData, unsigned pSize) {
+    close();
+    data = pData;
+    size = pSize;
+    return index();
+}
+
+void StatsLogReader::close() {
+#if STATS_LOG_USE_MMAP
+    if (mapped)
+        munmap(const_cast<uint8_t*>(data), size);
+#endif
+    buffer.clear();
+    blocks.clear();
+    data = 0;
+    size = rows = validEnd = 0;
+    mapped = false;
+}
+
+bool StatsLog::validBlock(const uint8_t* p, unsigned available) {
+    if (available < TableSize || memcmp(p, Magic, 4) || Bytes::read16(p + 4) != Version
+        || Bytes::read16(p + 6) != StatsColumn::Count)
+        return false;
+    const unsigned blockSize = Bytes::read32(p + 12);
+    if (blockSize < TableSize || blockSize > available
+        || Bytes::read32(p + 16) != Bytes::checksum(p + HeaderSize, blockSize - HeaderSize))
+        return false;
+    // columns fill the block, with at least one byte per value
+    const unsigned rows = Bytes::read32(p + 8);
+    if (rows > StatsLog::BlockRows)
+        return false;
+    unsigned columnsSize = 0;
+    for (int c=0; c<StatsColumn::Count; c++) {
+        const unsigned s = Bytes::read32(p + HeaderSize + 4 * c);
+        if (s < rows || s > blockSize - TableSize - columnsSize)
+            return false;
+        columnsSize += s;
+    }
+    return columnsSize == blockSize - TableSize;
+}
+
+bool StatsLogReader::index() {
+    blocks.clear();
+    rows = 0;
+    validEnd = 0;
+
+    unsigned offset = 0;
+    while (offset < size) {
+        const uint8_t* p = data + offset;
+        if (!StatsLog::validBlock(p, size - offset)) {
+            // a block cut or damaged by a crash: the next one starts with a magic
+            const unsigned next = nextMagic(data, size, offset);
+            LOGW("Invalid stats log block at " << offset << ", skipping " << (next - offset) << " bytes");
+            offset = next;
+            continue;
+        }
+        Block b;
+        b.rows = Bytes::read32(p + 8);
+        unsigned columnOffset = offset + TableSize;
+        for (int c=0; c<StatsColumn::Count; c++) {
+            b.sizes[c] = Bytes::read32(p + HeaderSize + 4 * c);
+            b.columns[c] = data + columnOffset;
+            columnOffset += b.sizes[c];
+        }
+        blocks.push_back(b);
+        rows += b.rows;
+        offset = columnOffset;
+        validEnd = offset;
+    }
+    return !blocks.empty();
+}
+
+void StatsLogReader::column(StatsColumn::Enum c, std::vector<int32_t>& out) const {
+    out.resize(rows);
+    int32_t* o = out.data();
+    for (unsigned b=0; b<blocks.size(); b++) {
+        o += column(c, b, o);
+    }
+}
+
+unsigned StatsLogReader::column(StatsColumn::Enum c, unsigned block, int32_t* out) const {
+    const Block& b = blocks[block];
+    const uint8_t* p = b.columns[c];
+    const uint8_t* end = p + b.sizes[c];
+    int32_t previous = 0;
+    for (unsigned i=0; i<b.rows; i++) {
+        uint32_t v;
+        Bytes::readVarint(p, end, v);
+        previous += unzigzag(v);
+        out[i] = previous;
+    }
+    return b.rows;
+}
@@ -0,0 +1,153 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+struct Statistics;
+
+/*
+ * Append-only log of every game statistics, one row per runner, stored by column so a
+ * query only decodes the columns it needs.
+ *
+ * The file is a sequence of blocks (at most StatsLog::BlockRows rows each), appended as
+ * games are played:
+ *  - Header: magic "RRSB", u16 version, u16 column count, u32 row count, u32 block size
+ *    (header included), u32 checksum of the rest of the block (see Bytes::checksum)
+ *  - column count x u32: compressed size of each column
+ *  - Columns, in StatsColumn order: each value is the zigzag LEB128 varint of its
+ *    difference with the previous value of the block (the first one with 0)
+ * Lifetimes are stored in StatsLog::LifetimeTicksPerSecond ticks. Integers are little-endian.
+ *
+ * A block cut or damaged by a crash is skipped: the reader resyncs on the next magic. Before
+ * appending, the writer drops whatever follows the last valid block.
+ *
+ * The reader maps the file and decodes one block at a time, so queries can stream the log
+ * with BlockRows values buffers. Aggregates are plain scalar loops: rows are decoded one
+ * varint at a time anyway, which costs more than the aggregation.
+ */
+namespace StatsColumn {
+    enum Enum {
+        // game end, in seconds since epoch: rows of a game share it
+        Time,
+        Level,
+        Score,
+        // runner index in the game
+        Runner,
+        Coins,
+        Lifetime,
+        Points,
+        Killed,
+        Oldness,
+        Bonus,
+        Count
+    };
+}
+
+namespace StatsLog {
+    const unsigned BlockRows = 4096;
+    const unsigned LifetimeTicksPerSecond = 100;
+
+    // nearest rank percentile (p in [0, 1]) of values, reordered in the process
+    int32_t percentile(std::vector<int32_t>& values, float p);
+
+    // p is a complete block (available bytes from p on)
+    bool validBlock(const uint8_t* p, unsigned available);
+
+    // mean of values for each runner index (rows of a same query); out[i] is runner i mean
+    void meanPerRunner(const std::vector<int32_t>& values, const std::vector<int32_t>& runners, std::vector<double>& out);
+
+    // same, fed block by block
+    class RunnerMeans {
+        public:
+            void add(const int32_t* values, const int32_t* runners, unsigned count);
+            void means(std::vector<double>& out) const;
+
+        private:
+            std::vector<int64_t> sums;
+            std::vector<unsigned> counts;
+    };
+}
+
+// Rows waiting to be written
+class StatsLogWriter {
+    public:
+        StatsLogWriter();
+
+        void add(const Statistics& stats, int level, uint32_t time);
+
+        unsigned pendingRows() const { return columns[0].size(); }
+
+        // encodes pending rows as blocks at the end of out, and forgets them
+        void encode(std::vector<uint8_t>& out);
+        // same, at the end of the file
+        bool append(const std::string& path);
+
+    private:
+        // drops the end of the file if it isn't a valid block
+        bool repair(const std::string& path);
+
+        std::vector<int32_t> columns[StatsColumn::Count];
+        // the file ends with a valid block (checked before the first append)
+        bool repaired;
+};
+
+class StatsLogReader {
+    public:
+        StatsLogReader();
+        ~StatsLogReader();
+
+        // maps the file in memory
+        bool open(const std::string& path);
+        // uses a memory block owned by the caller
+        bool open(const uint8_t* data, unsigned size);
+        void close();
+
+        unsigned rowCount() const { return rows; }
+        unsigned blockCount() const { return blocks.size(); }
+        // end of the last valid block
+        unsigned validSize() const { return validEnd; }
+        const uint8_t* bytes() const { return data; }
+        unsigned byteCount() const { return size; }
+
+        // every value of the column, in log order
+        void column(StatsColumn::Enum c, std::vector<int32_t>& out) const;
+        // values of the column in a block (at most StatsLog::BlockRows); returns their count
+        unsigned column(StatsColumn::Enum c, unsigned block, int32_t* out) const;
+
+    private:
+        bool index();
+
+    private:
+        struct Block {
+            unsigned rows;
+            const uint8_t* columns[StatsColumn::Count];
+            unsigned sizes[StatsColumn::Count];
+        };
+
+        const uint8_t* data;
+        unsigned size, rows, validEnd;
+        bool mapped;
+        // file content, when it cannot be mapped
+        std::vector<uint8_t> buffer;
+        std::vector<Block> blocks;
+};
@@ -0,0 +1,88 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+/*
+ * Broad phase along x between two groups of intervals (eg: ghosts and active runners):
+ * only pairs of intervals, one from each group, that overlap are reported. Buffers are
+ * kept from one call to the next.
+ */
+class SweepAndPrune {
+    public:
+        void clear() {
+            intervals[0].clear();
+            intervals[1].clear();
+        }
+
+        void add(int group, float minX, float maxX, int id) {
+            Interval in;
+            in.min = minX;
+            in.max = maxX;
+            in.id = id;
+            intervals[group].push_back(in);
+        }
+
+        // calls overlap(id of group 0, id of group 1) for each overlapping pair
+        template<typename F>
+        void findPairs(const F& overlap) {
+            if (intervals[0].empty() || intervals[1].empty())
+                return;
+            for (int g=0; g<2; g++) {
+                std::sort(intervals[g].begin(), intervals[g].end(), [] (const Interval& a, const Interval& b) -> bool {
+                    return a.min < b.min;
+                });
+                active[g].clear();
+            }
+
+            unsigned next[2] = { 0, 0 };
+            while (next[0] < intervals[0].size() || next[1] < intervals[1].size()) {
+                // the interval starting first enters the sweep
+                const int g = (next[1] == intervals[1].size() ||
+                    (next[0] < intervals[0].size() && intervals[0][next[0]].min <= intervals[1][next[1]].min)) ? 0 : 1;
+                const Interval& in = intervals[g][next[g]++];
+
+                std::vector<Interval>& others = active[1 - g];
+                for (unsigned i=0; i<others.size(); ) {
+                    if (others[i].max < in.min) {
+                        // ends before every interval still to come
+                        others[i] = others.back();
+                        others.pop_back();
+                    } else {
+                        if (g == 0)
+                            overlap(in.id, others[i].id);
+                        else
+                            overlap(others[i].id, in.id);
+                        i++;
+                    }
+                }
+                active[g].push_back(in);
+            }
+        }
+
+    private:
+        struct Interval {
+            float min, max;
+            int id;
+        };
+        std::vector<Interval> intervals[2], active[2];
+};
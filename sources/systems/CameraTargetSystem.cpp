@@ -36,6 +36,9 @@ CameraTargetSystem::CameraTargetSystem() : ComponentSystemImpl<CameraTargetCompo
     componentSerializer.add(new Property<float>(HASH("max_camera_speed", 0xec97a9bf), OFFSET(maxCameraSpeed, tc), 0.001));
     componentSerializer.add(new Property<bool>(HASH("enabled", 0x1d6995b7), OFFSET(enabled, tc)));
     componentSerializer.add(new Property<glm::vec2>(HASH("camera_speed", 0x7c76c3a2), OFFSET(cameraSpeed, tc), glm::vec2(0.001, 0)));
+
+    maxX = PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5);
+    minX = -maxX;
 }
 
 static glm::vec2 arrive(const glm::vec2& pos, const glm::vec2& ,const glm::vec2& targetPos, float maxSpeed, float deceleration) {
@@ -59,11 +62,7 @@ void CameraTargetSystem::DoUpdate(float dt) {
         glm::vec2 target (TRANSFORM(a)->position + ctc->offset);
 
         // limit offset to valid position
-        if (target.x < - PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5)) {
-            target.x = - PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5);
-        } else if (target.x > PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5)) {
-            target.x = PlacementHelper::ScreenSize.x * (param::LevelSize * 0.5 - 0.5);
-        }
+        target.x = glm::clamp(target.x, minX, maxX);
 
         glm::vec2 force = arrive(
             TRANSFORM(ctc->camera)->position,
@@ -35,4 +35,7 @@ struct CameraTargetComponent {
 #define CAM_TARGET(e) theCameraTargetSystem.Get(e)
 
 UPDATABLE_SYSTEM(CameraTarget)
+public:
+    // camera x limits, set from the current level size
+    float minX, maxX;
 };
@@ -23,11 +23,9 @@
 #include "systems/AnimationSystem.h"
 #include "systems/RenderingSystem.h"
 #include "systems/RunnerSystem.h"
-#include "util/IntersectionUtil.h"
 #include "util/SerializerProperty.h"
 #include <glm/gtx/rotate_vector.hpp>
-
-static bool onPlatform(const glm::vec2& position, float yEpsilon, Entity platform);
+#include "../Parameters.h"
 
 INSTANCE_IMPL(PlatformerSystem);
 
@@ -36,76 +34,83 @@ PlatformerSystem::PlatformerSystem() : ComponentSystemImpl<PlatformerComponent>(
     componentSerializer.add(new Property<glm::vec2>(HASH("previous_position", 0x4a11c67f), OFFSET(previousPosition, tc), glm::vec2(0.001, 0)));
     componentSerializer.add(new Property<glm::vec2>(HASH("offset", 0xc4601426), OFFSET(offset, tc), glm::vec2(0.001, 0)));
     componentSerializer.add(new EntityProperty(HASH("on_platform", 0xffbf19ad), OFFSET(onPlatform, tc)));
-    componentSerializer.add(new MapProperty<Entity, bool>(HASH("platforms", 0xd6198a31), OFFSET(platforms, tc)));
+}
+
+static RunnerRules::Box platformBox(Entity platform) {
+    const TransformationComponent* tc = TRANSFORM(platform);
+    return RunnerRules::Box(tc->position, tc->size, tc->rotation);
+}
+
+void PlatformerSystem::addPlatform(Entity platform, bool active) {
+    platforms.push_back(platform);
+    edges.add(platformBox(platform), active);
+}
+
+void PlatformerSystem::clearPlatforms() {
+    platforms.clear();
+    edges.clear();
+}
+
+void PlatformerSystem::setPlatformActive(Entity platform, bool active) {
+    const int i = platformIndex(platform);
+    if (i >= 0)
+        edges.setActive(i, active);
+}
+
+bool PlatformerSystem::isPlatformActive(Entity platform) const {
+    const int i = platformIndex(platform);
+    return i >= 0 && edges.isActive(i);
+}
+
+int PlatformerSystem::platformIndex(Entity platform, int hint) const {
+    if (hint >= 0 && hint < (int)platforms.size() && platforms[hint] == platform)
+        return hint;
+    for (unsigned i=0; i<platforms.size(); i++) {
+        if (platforms[i] == platform)
+            return i;
+    }
+    return -1;
 }
 
 void PlatformerSystem::DoUpdate(float) {
+    // top edges only change when platforms are moved
+    for (unsigned i=0; i<platforms.size(); i++) {
+        edges.move(i, platformBox(platforms[i]));
+    }
+    edges.update();
+
     FOR_EACH_ENTITY_COMPONENT(Platformer, entity, pltf)
         PhysicsComponent* pc = PHYSICS(entity);
         TransformationComponent* tc = TRANSFORM(entity);
         glm::vec2 newPosition(tc->position + glm::rotate(pltf->offset, tc->rotation));
 
-        // if going down
-        if (pc->linearVelocity.y < 0) {
-            TransformationComponent* tc = TRANSFORM(entity);
-
-            // did we intersect a platform ?
-            for (std::map<Entity, bool>::const_iterator it=pltf->platforms.begin(); it != pltf->platforms.end(); ++it) {
-                if (!it->second)
-                    continue;
-                TransformationComponent* pltfTC = TRANSFORM(it->first);
-                if (IntersectionUtil::lineLine(
-                    pltf->previousPosition, newPosition,
-                    pltfTC->position + glm::rotate(glm::vec2(pltfTC->size.x * 0.5, pltfTC->size.y * 0.5), pltfTC->rotation),
-                    pltfTC->position + glm::rotate(glm::vec2(-pltfTC->size.x * 0.5, pltfTC->size.y * 0.5), pltfTC->rotation),
-                    0)) {
-                    // We did intersect...
-                    pc->gravity.y = 0;
-                    pc->linearVelocity = glm::vec2(0.0f);
-                    tc->position.y = pltfTC->position.y + tc->size.y * 0.5;
-                    ANIMATION(entity)->name = HASH("jumptorunL2R", 0x9bdaadc5);
-                    if (RUNNER(entity)->speed < 0)
-                        RENDERING(entity)->flags |= RenderingFlags::MirrorHorizontal;
-                    else
-                        RENDERING(entity)->flags &= ~(RenderingFlags::MirrorHorizontal);
-                    newPosition = tc->position + glm::rotate(pltf->offset, tc->rotation);
-                    pltf->onPlatform = it->first;
-                    break;
-                }
-            }
-        } else if (pc->linearVelocity.y == 0) {
-            if (pltf->onPlatform) {
-                if (!onPlatform(newPosition, 0.5, pltf->onPlatform)) {
-                    bool foundNew = false;
-                    for (std::map<Entity, bool>::const_iterator it=pltf->platforms.begin(); it != pltf->platforms.end(); ++it) {
-                        if (it->first == pltf->onPlatform || !it->second)
-                            continue;
-                        if (onPlatform(newPosition, 0.5, it->first)) {
-                            pltf->onPlatform = it->first;
-                            foundNew = true;
-                        }
-                    }
-                    if (!foundNew) {
-                        pltf->onPlatform = 0;
-                        pc->gravity.y= -150;
-                        LOGV(1, "No on a platform anymore");
-                    }
-                } else if (!pltf->platforms[pltf->onPlatform]) {
-                    pltf->onPlatform = 0;
-                    pc->gravity.y = -150;
-                }
-            }
-        } else {
-            pltf->onPlatform = 0;
+        bool standing = (pltf->onPlatform != 0);
+        int current = standing ? platformIndex(pltf->onPlatform, pltf->onPlatformIndex) : -1;
+        switch (edges.step(pc->linearVelocity.y, pltf->previousPosition, newPosition,
+            standing, current, pltf->platformsVersion)) {
+            case RunnerRules::PlatformerEvent::Landed:
+                pc->gravity.y = 0;
+                pc->linearVelocity = glm::vec2(0.0f);
+                tc->position.y = edges.box(current).position.y + tc->size.y * 0.5;
+                ANIMATION(entity)->name = HASH("jumptorunL2R", 0x9bdaadc5);
+                if (RUNNER(entity)->speed < 0)
+                    RENDERING(entity)->flags |= RenderingFlags::MirrorHorizontal;
+                else
+                    RENDERING(entity)->flags &= ~(RenderingFlags::MirrorHorizontal);
+                newPosition = tc->position + glm::rotate(pltf->offset, tc->rotation);
+                break;
+            case RunnerRules::PlatformerEvent::Fell:
+                pc->gravity.y = param::FallGravity;
+                LOGV(1, "No on a platform anymore");
+                break;
+            default:
+                break;
         }
+        if (!standing)
+            pltf->onPlatform = 0;
+        else if (current >= 0)
+            pltf->onPlatform = platforms[current];
+        pltf->onPlatformIndex = current;
         pltf->previousPosition = newPosition;
     }
 }
-
-static bool onPlatform(const glm::vec2& position, float yEpsilon, Entity platform) {
-    const TransformationComponent* pltfTC = TRANSFORM(platform);
-    return IntersectionUtil::lineLine(position + glm::vec2(0, yEpsilon), position - glm::vec2(0, yEpsilon),
-        pltfTC->position + glm::rotate(glm::vec2(pltfTC->size.x * 0.5, pltfTC->size.y * 0.5), pltfTC->rotation),
-        pltfTC->position + glm::rotate(glm::vec2(-pltfTC->size.x * 0.5, pltfTC->size.y * 0.5), pltfTC->rotation),
-        0);
-}
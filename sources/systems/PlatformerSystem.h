@@ -21,16 +21,38 @@
 
 #include "systems/System.h"
 #include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+#include "../simulation/RunnerRules.h"
 
 struct PlatformerComponent {
-    PlatformerComponent() : previousPosition(0.0f), offset(0.0f), onPlatform(0) {}
+    PlatformerComponent() : previousPosition(0.0f), offset(0.0f), onPlatform(0), platformsVersion(0), onPlatformIndex(-1) {}
     glm::vec2 previousPosition, offset;
     Entity onPlatform;
-    std::map<Entity, bool> platforms;
+    // PlatformerSystem platforms version onPlatform was last checked against
+    unsigned platformsVersion;
+    // index of onPlatform in PlatformerSystem platforms (not saved, only a hint)
+    int onPlatformIndex;
 };
 
 #define thePlatformerSystem PlatformerSystem::GetInstance()
 #define PLATFORMER(e) thePlatformerSystem.Get(e)
 
 UPDATABLE_SYSTEM(Platformer)
+public:
+    // Platforms every platformer can land on (see RunnerRules::PlatformEdges). Their top
+    // edges are cached, and computed again only when their transform changes.
+    void addPlatform(Entity platform, bool active);
+    void clearPlatforms();
+    // inactive platforms are ignored; changing it bumps the platforms version
+    void setPlatformActive(Entity platform, bool active);
+    bool isPlatformActive(Entity platform) const;
+
+private:
+    int platformIndex(Entity platform, int hint = -1) const;
+
+    // platform entities, at the same index as their edge
+    std::vector<Entity> platforms;
+    RunnerRules::PlatformEdges edges;
 };
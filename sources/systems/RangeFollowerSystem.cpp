@@ -20,6 +20,10 @@
 #include "RangeFollowerSystem.h"
 #include "systems/TransformationSystem.h"
 #include "util/SerializerProperty.h"
+#include "base/Log.h"
+
+#include <algorithm>
+#include <map>
 
 INSTANCE_IMPL(RangeFollowerSystem);
 
@@ -29,18 +33,75 @@ RangeFollowerSystem::RangeFollowerSystem() : ComponentSystemImpl<RangeFollowerCo
     componentSerializer.add(new IntervalProperty<float>(HASH("range", 0x85dd6984), OFFSET(range, tc)));
 }
 
+void RangeFollowerSystem::buildChain() {
+    std::map<Entity, Entity> parents;
+    followers.clear();
+    followerParents.clear();
+    FOR_EACH_ENTITY_COMPONENT(RangeFollower, a, rc)
+        parents[a] = rc->parent;
+        followers.push_back(a);
+        followerParents.push_back(rc->parent);
+    }
+
+    // followers sorted by depth: parents have a smaller one
+    std::vector<std::pair<int, Entity> > sorted;
+    for (const auto& p: parents) {
+        int depth = 0;
+        for (Entity e = p.second; e; depth++) {
+            auto it = parents.find(e);
+            LOGF_IF(it == parents.end(), "RangeFollower " << p.first << " follows " << e << " which isn't a RangeFollower");
+            LOGF_IF(depth > (int)parents.size(), "RangeFollower " << p.first << " parents loop");
+            e = it->second;
+        }
+        sorted.push_back(std::make_pair(depth, p.first));
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    std::map<Entity, int> index;
+    chain.resize(sorted.size());
+    for (unsigned i=0; i<sorted.size(); i++) {
+        chain[i] = sorted[i].second;
+        index[chain[i]] = i;
+    }
+    chainParent.resize(chain.size());
+    for (unsigned i=0; i<chain.size(); i++) {
+        const Entity parent = parents[chain[i]];
+        chainParent[i] = parent ? index[parent] : -1;
+    }
+    chainX.resize(chain.size());
+    chainRange.resize(chain.size());
+}
+
 void RangeFollowerSystem::DoUpdate(float) {
+    // same count isn't enough: a follower may have been deleted and another one added
+    bool stale = (followers.size() != entityCount());
+    unsigned n = 0;
     FOR_EACH_ENTITY_COMPONENT(RangeFollower, a, rc)
-        TransformationComponent* tc = TRANSFORM(a);
-        if (rc->parent) {
-            RangeFollowerComponent* parentRf = RANGE_FOLLOWER(rc->parent);
-            float t = parentRf->range.position(TRANSFORM(rc->parent)->position.x);
-            tc->position.x = rc->range.lerp(t);
+        if (stale)
+            break;
+        stale = (followers[n] != a || followerParents[n] != rc->parent);
+        n++;
+    }
+    if (stale)
+        buildChain();
+
+    for (unsigned i=0; i<chain.size(); i++) {
+        const RangeFollowerComponent* rc = RANGE_FOLLOWER(chain[i]);
+        chainX[i] = TRANSFORM(chain[i])->position.x;
+        chainRange[i] = rc->range;
+    }
+
+    // parents come first: they're already up to date when their followers read them
+    for (unsigned i=0; i<chain.size(); i++) {
+        const int p = chainParent[i];
+        if (p >= 0) {
+            chainX[i] = chainRange[i].lerp(chainRange[p].position(chainX[p]));
         } else {
-            if (tc->position.x < rc->range.t1)
-                tc->position.x = rc->range.t1;
-            else if (tc->position.x > rc->range.t2)
-                tc->position.x = rc->range.t2;
+            chainX[i] = glm::clamp(chainX[i], chainRange[i].t1, chainRange[i].t2);
         }
     }
+
+    for (unsigned i=0; i<chain.size(); i++) {
+        TRANSFORM(chain[i])->position.x = chainX[i];
+    }
 }
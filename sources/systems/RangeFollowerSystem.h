@@ -22,6 +22,8 @@
 #include "systems/System.h"
 #include "base/Interval.h"
 
+#include <vector>
+
 struct RangeFollowerComponent {
     Interval<float> range;
     Entity parent;
@@ -31,4 +33,18 @@ struct RangeFollowerComponent {
 #define RANGE_FOLLOWER(e) theRangeFollowerSystem.Get(e)
 
 UPDATABLE_SYSTEM(RangeFollower)
+private:
+    // Followers sorted parents first, so one pass reads up to date parent positions.
+    // Rebuilt when followers are added or removed, or when a parent changes.
+    void buildChain();
+
+    // followers and their parent, in system order, as of the last buildChain
+    std::vector<Entity> followers, followerParents;
+
+    std::vector<Entity> chain;
+    // index of the parent in chain, -1 for roots
+    std::vector<int> chainParent;
+    // per frame copies, updated in one batch
+    std::vector<float> chainX;
+    std::vector<Interval<float> > chainRange;
 };
@@ -24,22 +24,29 @@
 #include "systems/RenderingSystem.h"
 #include "systems/AnimationSystem.h"
 #include "systems/AnchorSystem.h"
-#include "systems/AutoDestroySystem.h"
+#include "systems/SessionSystem.h"
+#include "systems/PlatformerSystem.h"
+#include "systems/CameraTargetSystem.h"
 #include "util/IntersectionUtil.h"
 #include "util/SerializerProperty.h"
 
+#include <algorithm>
+
 #include "../RecursiveRunnerGame.h"
-std::map<TextureRef, CollisionZone> texture2Collision;
+#include "../simulation/Replay.h"
+#include "../simulation/RunnerRules.h"
+#include "../Parameters.h"
 
 INSTANCE_IMPL(RunnerSystem);
 
-float RunnerSystem::MinJumpDuration = 0.005;
-float RunnerSystem::MaxJumpDuration = 0.2;
+float RunnerSystem::MinJumpDuration = param::MinJumpDuration;
+float RunnerSystem::MaxJumpDuration = param::MaxJumpDuration;
 
 RunnerSystem::RunnerSystem() : ComponentSystemImpl<RunnerComponent>(HASH("Runner", 0xe5dc730a), ComponentType::Complex) {
     RunnerComponent tc;
     componentSerializer.add(new EntityProperty(HASH("player_owner", 0xd5181aa0), OFFSET(playerOwner, tc)));
     componentSerializer.add(new EntityProperty(HASH("collision_zone", 0x2a513634), OFFSET(collisionZone, tc)));
+    componentSerializer.add(new EntityProperty(HASH("session", 0xba9956b4), OFFSET(session, tc)));
     componentSerializer.add(new Property<glm::vec2>(HASH("start_point", 0xdd8c9350), OFFSET(startPoint.x, tc), glm::vec2(0.001, 0)));
     componentSerializer.add(new Property<glm::vec2>(HASH("end_point", 0x85fa62a4), OFFSET(endPoint, tc), glm::vec2(0.001, 0)));
     componentSerializer.add(new Property<Color>(HASH("color", 0xccc35cf8), OFFSET(color, tc)));
@@ -52,38 +59,254 @@ RunnerSystem::RunnerSystem() : ComponentSystemImpl<RunnerComponent>(HASH("Runner
     componentSerializer.add(new Property<bool>(HASH("current_jump", 0x9bb0b842), OFFSET(currentJump, tc)));
     componentSerializer.add(new Property<int>(HASH("oldness_bonus", 0x14ad4fd5), OFFSET(oldNessBonus, tc)));
     componentSerializer.add(new Property<int>(HASH("coin_sequence_bonus", 0xe7d65188), OFFSET(coinSequenceBonus, tc)));
-    componentSerializer.add(new VectorProperty<float>(HASH("jump_times", 0xf291681a), OFFSET(jumpTimes, tc)));
-    componentSerializer.add(new VectorProperty<float>(HASH("jump_durations", 0xa9048c79), OFFSET(jumpDurations, tc)));
+    componentSerializer.add(new Property<int>(HASH("jump_track", 0x41f982a1), OFFSET(jumpTrack, tc)));
     componentSerializer.add(new Property<int>(HASH("total_coins_earned", 0x7852232e), OFFSET(totalCoinsEarned, tc)));
-    componentSerializer.add(new VectorProperty<float>(HASH("coins", 0xb2cf216c), OFFSET(coins, tc)));
+    componentSerializer.add(new VectorProperty<int>(HASH("coins", 0xb2cf216c), OFFSET(coins, tc)));
+    componentSerializer.add(new Property<float>(HASH("impulse_left", 0x63d56327), OFFSET(impulseLeft, tc), 0.001));
+    componentSerializer.add(new Property<bool>(HASH("hold_force", 0x200adb62), OFFSET(holdForce, tc)));
+    componentSerializer.add(new Property<glm::vec2>(HASH("previous_tick_position", 0xa3b843e), OFFSET(previousTickPosition, tc), glm::vec2(0.001, 0)));
+    componentSerializer.add(new Property<glm::vec2>(HASH("tick_position", 0x330db031), OFFSET(tickPosition, tc), glm::vec2(0.001, 0)));
+}
+
+// Template state of pooled entities, captured from their first instance: recycled
+// entities are reset with these, without parsing their template again.
+static struct {
+    bool captured;
+    TransformationComponent transform;
+    RenderingComponent rendering;
+    RunnerComponent runner;
+    PlatformerComponent platformer;
+    CameraTargetComponent cameraTarget;
+    PhysicsComponent physics;
+    AnimationComponent animation;
+} runnerTemplate;
+
+static struct {
+    bool captured;
+    TransformationComponent transform;
+    RenderingComponent rendering;
+    AnimationComponent animation;
+} killAnimationTemplate;
+
+// length of the disappear2 animation
+static const float KillAnimationDuration = 0.3333;
+
+Entity RunnerSystem::instantiateRunner() {
+    Entity e = theEntityManager.CreateEntityFromTemplate("ingame/runner");
+    if (!runnerTemplate.captured) {
+        runnerTemplate.transform = *TRANSFORM(e);
+        runnerTemplate.rendering = *RENDERING(e);
+        runnerTemplate.runner = *RUNNER(e);
+        runnerTemplate.platformer = *PLATFORMER(e);
+        runnerTemplate.cameraTarget = *CAM_TARGET(e);
+        runnerTemplate.physics = *PHYSICS(e);
+        runnerTemplate.animation = *ANIMATION(e);
+        runnerTemplate.captured = true;
+    }
+    // a runner keeps its collision zone, and its slot, when recycled
+    Entity collisionZone = theEntityManager.CreateEntityFromTemplate("ingame/collision_zone");
+    ANCHOR(collisionZone)->parent = e;
+    RUNNER(e)->collisionZone = collisionZone;
+    RUNNER(e)->slot = kinematics.add(0, 0, 0, 0);
+    // inactive until it joins a session
+    kinematics.active[RUNNER(e)->slot] = 0;
+    return e;
+}
+
+Entity RunnerSystem::instantiateKillAnimation() {
+    // not saved: kill animations don't outlive a restart (see rebuildPools)
+    Entity e = theEntityManager.CreateEntity(HASH("ingame/kill_runner_anim", 0x1f6362e2),
+        EntityType::Volatile, theEntityManager.entityTemplateLibrary.load("ingame/kill_runner_anim"));
+    if (!killAnimationTemplate.captured) {
+        killAnimationTemplate.transform = *TRANSFORM(e);
+        killAnimationTemplate.rendering = *RENDERING(e);
+        killAnimationTemplate.animation = *ANIMATION(e);
+        killAnimationTemplate.captured = true;
+    }
+    return e;
+}
+
+void RunnerSystem::preallocate(unsigned runnerCount) {
+    while (runnerPool.size() < runnerCount) {
+        Entity e = instantiateRunner();
+        recycleRunner(e);
+    }
+    // a kill animation is short, a few are enough
+    const unsigned killAnimationCount = glm::max(1u, runnerCount / 2);
+    while (killAnimationPool.size() < killAnimationCount) {
+        Entity e = instantiateKillAnimation();
+        RENDERING(e)->show = false;
+        killAnimationPool.push_back(e);
+    }
+    killAnimations.reserve(killAnimationCount);
+}
+
+void RunnerSystem::rebuildPools() {
+    runnerPool.clear();
+    kinematics = RunnerKinematics();
+    FOR_EACH_ENTITY_COMPONENT(Runner, e, rc)
+        if (!rc->session)
+            runnerPool.push_back(e);
+        // runners in a session are loaded from their component at next update
+        rc->slot = kinematics.add(0, 0, 0, 0);
+        kinematics.active[rc->slot] = 0;
+    }
+    // restored runners aren't in their template state: capture it from a new one
+    if (!runnerTemplate.captured) {
+        recycleRunner(instantiateRunner());
+    }
+    killAnimations.clear();
+    killAnimationPool.clear();
+}
+
+void RunnerSystem::syncCollisionZone(const RunnerComponent* rc, const TransformationComponent* tc) {
+    TransformationComponent* zone = TRANSFORM(rc->collisionZone);
+    zone->position = tc->position + ANCHOR(rc->collisionZone)->position;
+    zone->rotation = ANCHOR(rc->collisionZone)->rotation;
+}
+
+Entity RunnerSystem::spawnRunner() {
+    if (runnerPool.empty()) {
+        LOGW("Runner pool is empty");
+        return instantiateRunner();
+    }
+    Entity e = runnerPool.back();
+    runnerPool.pop_back();
+
+    const Entity collisionZone = RUNNER(e)->collisionZone;
+    const int slot = RUNNER(e)->slot;
+    *TRANSFORM(e) = runnerTemplate.transform;
+    *RENDERING(e) = runnerTemplate.rendering;
+    *RUNNER(e) = runnerTemplate.runner;
+    *PLATFORMER(e) = runnerTemplate.platformer;
+    *CAM_TARGET(e) = runnerTemplate.cameraTarget;
+    *PHYSICS(e) = runnerTemplate.physics;
+    *ANIMATION(e) = runnerTemplate.animation;
+    RUNNER(e)->collisionZone = collisionZone;
+    RUNNER(e)->slot = slot;
+    return e;
+}
+
+void RunnerSystem::recycleRunner(Entity runner) {
+    // reused runners join the group again when spawned (see GameScene addRunnerToPlayer)
+    if (RUNNER(runner)->session)
+        SESSION(RUNNER(runner)->session)->renderGroup.remove(runner);
+    // no session: ignored by RunnerSystem
+    RUNNER(runner)->session = 0;
+    kinematics.active[RUNNER(runner)->slot] = 0;
+    RENDERING(runner)->show = false;
+    PHYSICS(runner)->mass = 0;
+    CAM_TARGET(runner)->enabled = false;
+    ANIMATION(runner)->playbackSpeed = 0;
+    runnerPool.push_back(runner);
+}
+
+void RunnerSystem::recycleKillAnimations() {
+    for (unsigned i=0; i<killAnimations.size(); i++) {
+        RENDERING(killAnimations[i].first)->show = false;
+        killAnimationPool.push_back(killAnimations[i].first);
+    }
+    killAnimations.clear();
 }
 
-static void killRunner(Entity runner) {
+void RunnerSystem::killRunner(Entity runner) {
     RENDERING(runner)->show = false;
-    Entity e = theEntityManager.CreateEntityFromTemplate("ingame/kill_runner_anim");
+    Entity e;
+    if (killAnimationPool.empty()) {
+        e = instantiateKillAnimation();
+    } else {
+        e = killAnimationPool.back();
+        killAnimationPool.pop_back();
+        *RENDERING(e) = killAnimationTemplate.rendering;
+        *ANIMATION(e) = killAnimationTemplate.animation;
+    }
     *TRANSFORM(e) = *TRANSFORM(runner);
     TRANSFORM(e)->position.y += TRANSFORM(e)->size.y * 0.1;
     RENDERING(e)->texture = RENDERING(runner)->texture;
     RENDERING(e)->color.a = 0.5;
+    killAnimations.push_back(std::make_pair(e, KillAnimationDuration));
+}
+
+void RunnerSystem::loadSlot(const RunnerComponent* rc) {
+    const int i = rc->slot;
+    kinematics.speed[i] = rc->speed;
+    kinematics.endX[i] = rc->endPoint.x;
+    kinematics.startTime[i] = rc->startTime;
+    kinematics.elapsed[i] = rc->elapsed;
+    kinematics.jumpingSince[i] = rc->jumpingSince;
+    kinematics.impulseLeft[i] = rc->impulseLeft;
+    kinematics.holdForce[i] = rc->holdForce ? ~0 : 0;
+    kinematics.active[i] = ~0;
 }
 
+void RunnerSystem::refreshJump(const RunnerComponent* rc) {
+    const JumpTrackArena& jumps = SESSION(rc->session)->jumps;
+    if (rc->currentJump < jumps.size(rc->jumpTrack))
+        kinematics.setJump(rc->slot, jumps.time(rc->jumpTrack, rc->currentJump), jumps.duration(rc->jumpTrack, rc->currentJump));
+    else
+        kinematics.clearJump(rc->slot);
+}
+
+void RunnerSystem::finishRunner(Entity a, RunnerComponent* rc) {
+    const int i = rc->slot;
+    if (!rc->ghost)
+        LOGV(1, a << " finished! (" << rc->coins.size() << ") (pos=" << kinematics.positionX[i]
+            << ") "<< rc->endPoint.x);
+    ANIMATION(a)->name = HASH("runL2R", 0xda1d330c);
+    RunnerRules::finishRun(*rc);
+    SessionComponent* sc = SESSION(rc->session);
+    if (sc->nextRunnerStartTimeIndex >= (int)sc->nextRunnerStartTime.size()) {
+        // endless sessions outlive the start times drawn by startGame
+        sc->nextRunnerStartTime.push_back(Replay::quantize(sc->random.Float(0.0f, 2.0f)));
+    }
+    rc->startTime = kinematics.startTime[i] = sc->nextRunnerStartTime[sc->nextRunnerStartTimeIndex++];
+    RENDERING(a)->color = Color(27.0/255, 2.0/255, 2.0/255, 0.8);
+    kinematics.positionX[i] = rc->startPoint.x;
+    kinematics.positionY[i] = rc->startPoint.y;
+    kinematics.elapsed[i] = kinematics.jumpingSince[i] = 0;
+
+    PHYSICS(a)->linearVelocity = glm::vec2(0.0f);
+    kinematics.velocityY[i] = 0;
+    kinematics.gravity[i] = 0;
+    refreshJump(rc);
+}
+
+static void setMirrored(Entity a, const RunnerComponent* rc) {
+    if (rc->speed < 0)
+        RENDERING(a)->flags |= RenderingFlags::MirrorHorizontal;
+    else
+        RENDERING(a)->flags &= ~(RenderingFlags::MirrorHorizontal);
+}
+
+// Runners are advanced in one vectorized pass (RunnerKinematics, the SessionSimulator kernel),
+// rare events being handled one runner at a time. Fixed timestep: runners physics is
+// integrated by the kernel too, at each tick, and not by PhysicsSystem (which is updated once
+// per frame); otherwise jumps become PhysicsSystem forces.
 void RunnerSystem::DoUpdate(float dt) {
-    std::vector<Entity> killedRunners;
+    const bool fixedStep = (param::SimulationTickRate > 0);
+    killedRunners.clear();
+    advancedRunners.clear();
+
+    // components -> slots: other systems (PlatformerSystem landings, tick positions restored
+    // by GameScene, jump inputs) change runners between updates
     FOR_EACH_ENTITY_COMPONENT(Runner, a, rc)
+        // pooled
+        if (!rc->session)
+            continue;
         PhysicsComponent* pc = PHYSICS(a);
-        pc->mass = 1;
+        // no mass: ignored by PhysicsSystem
+        pc->mass = fixedStep ? 0 : 1;
         TransformationComponent* tc = TRANSFORM(a);
         {
             RenderingComponent* rendc = RENDERING(a);
-            auto* tta = ANCHOR(rc->collisionZone);
-            auto* ttt = TRANSFORM(rc->collisionZone);
-            const CollisionZone& cz = texture2Collision[rendc->texture];
-            tta->position = tc->size * cz.position;
-            ttt->size = tc->size * cz.size;
-            tta->rotation = cz.rotation;
-            if (rendc->flags & RenderingFlags::MirrorHorizontal) {
-                ttt->position.x = -ttt->position.x;
-                ttt->rotation = -ttt->rotation;
+            const CollisionZone* cz = RunnerCollision::find(rendc->texture,
+                rendc->flags & RenderingFlags::MirrorHorizontal);
+            // other textures (none yet) keep the previous zone
+            if (cz) {
+                auto* tta = ANCHOR(rc->collisionZone);
+                tta->position = tc->size * cz->position;
+                TRANSFORM(rc->collisionZone)->size = tc->size * cz->size;
+                tta->rotation = cz->rotation;
             }
         }
         if (rc->killed) {
@@ -92,74 +315,76 @@ void RunnerSystem::DoUpdate(float dt) {
                 killedRunners.push_back(a);
             }
             rc->elapsed = -1;
+            kinematics.active[rc->slot] = 0;
             continue;
         }
 
-        rc->elapsed += dt;
-
-        if (rc->elapsed >= rc->startTime) {
-            tc->position.x += rc->speed * dt;
-
-            if ((tc->position.x > rc->endPoint.x && rc->speed > 0) ||
-                (tc->position.x < rc->endPoint.x && rc->speed < 0)) {
-                if (!rc->ghost)
-                    LOGV(1, a << " finished! (" << rc->coins.size() << ") (pos=" << tc->position
-                        << ") "<< rc->endPoint.x);
-                ANIMATION(a)->name = HASH("runL2R", 0xda1d330c);
-                rc->finished = true;
-                rc->oldNessBonus++;
-                rc->coinSequenceBonus = 1;
-                rc->ghost = true;
-                LOGF_IF(RecursiveRunnerGame::nextRunnerStartTimeIndex >= 100, "Not enough start times");
-                rc->startTime = RecursiveRunnerGame::nextRunnerStartTime[RecursiveRunnerGame::nextRunnerStartTimeIndex++];
-                RENDERING(a)->color = Color(27.0/255, 2.0/255, 2.0/255, 0.8);
-                tc->position = rc->startPoint;
-                rc->elapsed = rc->jumpingSince = 0;
-                rc->currentJump = 0;
-
-                pc->linearVelocity =  glm::vec2(0.0f);
-                pc->gravity.y = 0;
-                rc->totalCoinsEarned = rc->coins.size();
-                rc->coins.clear();
-            }
-        }
+        const int i = rc->slot;
+        if (!kinematics.active[i])
+            loadSlot(rc);
+        kinematics.positionX[i] = tc->position.x;
+        kinematics.positionY[i] = tc->position.y;
+        kinematics.velocityY[i] = pc->linearVelocity.y;
+        kinematics.gravity[i] = pc->gravity.y;
+        // tracks are extended by inputs
+        refreshJump(rc);
+        advancedRunners.push_back(a);
+    }
+
+    kinematics.advance(dt);
+
+    for (unsigned k=0; k<advancedRunners.size(); k++) {
+        const Entity a = advancedRunners[k];
+        RunnerComponent* rc = RUNNER(a);
+        const int i = rc->slot;
 
-        if (!rc->jumpTimes.empty() && rc->currentJump < (int)rc->jumpTimes.size()) {
-            if ((rc->elapsed - rc->startTime)>= rc->jumpTimes[rc->currentJump] && rc->jumpingSince == 0) {
-                // std::cout << a << " -> jump #" << rc->currentJump << " -> " << rc->jumpTimes[rc->currentJump] << std::endl;
-                glm::vec2 force(0, 1800 * 1.5);
-                pc->forces.push_back(std::make_pair(Force(force,  glm::vec2(0.0f)), RunnerSystem::MinJumpDuration));
-                rc->jumpingSince = 0.001;
-                pc->gravity.y = -50;
-                ANIMATION(a)->name = HASH("jumpL2R_up", 0xc043b37b);
-                if (rc->speed < 0)
-                    RENDERING(a)->flags |= RenderingFlags::MirrorHorizontal;
-                else
-                    RENDERING(a)->flags &= ~(RenderingFlags::MirrorHorizontal);
-            } else {
-                if (rc->jumpingSince > 0) {
-                    rc->jumpingSince += dt;
-                    if (rc->jumpingSince > rc->jumpDurations[rc->currentJump]) {// && rc->jumpingSince >= MinJumpDuration) {
-                        //ANIMATION(a)->name = (rc->speed > 0) ? "jumpL2R_down" : "jumpR2L_down";
-                        pc->gravity.y = -150;
-                        rc->jumpingSince = 0;
-                        rc->currentJump++;
-                        } else {
-                         glm::vec2 force(0, 100 * 1);
-                        pc->forces.push_back(std::make_pair(Force(force,  glm::vec2(0.0f)), dt));
-                    }
-                }
+        int events = kinematics.events[i];
+        if (events & RunnerEvent::Finished) {
+            finishRunner(a, rc);
+            events = kinematics.advanceJump(i, dt);
+        }
+        if (events & RunnerEvent::JumpStart) {
+            if (!fixedStep) {
+                glm::vec2 force(0, param::JumpImpulse);
+                PHYSICS(a)->forces.push_back(std::make_pair(Force(force,  glm::vec2(0.0f)), RunnerSystem::MinJumpDuration));
+                kinematics.impulseLeft[i] = 0;
             }
+            ANIMATION(a)->name = HASH("jumpL2R_up", 0xc043b37b);
+            setMirrored(a, rc);
+        } else if (events & RunnerEvent::JumpEnd) {
+            rc->currentJump++;
+            refreshJump(rc);
+        } else if (kinematics.holdForce[i] && !fixedStep) {
+            glm::vec2 force(0, param::JumpHoldForce);
+            PHYSICS(a)->forces.push_back(std::make_pair(Force(force,  glm::vec2(0.0f)), dt));
+            kinematics.holdForce[i] = 0;
         }
-        if (pc->gravity.y < 0 && pc->linearVelocity.y < -10) {
+        if (kinematics.gravity[i] < 0 && kinematics.velocityY[i] < -10) {
             ANIMATION(a)->name = HASH("jumpL2R_down", 0xc810b848);
-            if (rc->speed < 0)
-                RENDERING(a)->flags |= RenderingFlags::MirrorHorizontal;
-            else
-                RENDERING(a)->flags &= ~(RenderingFlags::MirrorHorizontal);
+            setMirrored(a, rc);
         }
-             /*RENDERING(a)->texture = InvalidTextureRef;
-            ANIMATION(a)->name = "";*/
+    }
+
+    if (fixedStep) {
+        kinematics.integrate(dt);
+    }
+
+    // slots -> components
+    for (unsigned k=0; k<advancedRunners.size(); k++) {
+        const Entity a = advancedRunners[k];
+        RunnerComponent* rc = RUNNER(a);
+        const int i = rc->slot;
+        rc->elapsed = kinematics.elapsed[i];
+        rc->jumpingSince = kinematics.jumpingSince[i];
+        rc->impulseLeft = kinematics.impulseLeft[i];
+        rc->holdForce = (kinematics.holdForce[i] != 0);
+        TransformationComponent* tc = TRANSFORM(a);
+        tc->position = glm::vec2(kinematics.positionX[i], kinematics.positionY[i]);
+        PhysicsComponent* pc = PHYSICS(a);
+        pc->linearVelocity.y = kinematics.velocityY[i];
+        pc->gravity.y = kinematics.gravity[i];
+        if (fixedStep)
+            syncCollisionZone(rc, tc);
     }
 
     if (!killedRunners.empty()) {
@@ -167,15 +392,24 @@ void RunnerSystem::DoUpdate(float dt) {
             Entity a = killedRunners[i];
             int bonus = RUNNER(a)->oldNessBonus;
             FOR_EACH_ENTITY_COMPONENT(Runner, b, rc)
-                if (b == a)
+                if (b == a || !rc->session)
                     continue;
-                if (bonus < rc->oldNessBonus) {
-                    rc->oldNessBonus--;
-                    assert(rc->oldNessBonus >= 0);
-                }
+                rc->oldNessBonus = RunnerRules::oldNessAfterKill(rc->oldNessBonus, bonus);
+                assert(rc->oldNessBonus >= 0);
             }
-            theEntityManager.DeleteEntity(RUNNER(a)->collisionZone);
-            theEntityManager.DeleteEntity(a);
+            recycleRunner(a);
+        }
+    }
+
+    for (unsigned i=0; i<killAnimations.size(); ) {
+        killAnimations[i].second -= dt;
+        if (killAnimations[i].second <= 0) {
+            RENDERING(killAnimations[i].first)->show = false;
+            killAnimationPool.push_back(killAnimations[i].first);
+            killAnimations[i] = killAnimations.back();
+            killAnimations.pop_back();
+        } else {
+            i++;
         }
     }
 }
@@ -23,34 +23,42 @@
 #include "base/Color.h"
 #include <glm/glm.hpp>
 #include "../RecursiveRunnerGame.h"
+#include "../simulation/CollisionZone.h"
+#include "../simulation/RunnerKinematics.h"
 
-struct CollisionZone {
-    CollisionZone(float x=0,float y=0,float w=0, float h=0, float r=0) {
-        size.x = w / 200.0; size.y = h / 210.0;
-        position.x = x / 200.0 - 0.5;// + size.X * 0.5;
-        position.y = 0.5 - y / 210.0;// - size.Y * 0.5;
-        rotation = r;
-    }
-    glm::vec2 position, size;
-    float rotation;
-};
+struct TransformationComponent;
 
 struct RunnerComponent {
-    RunnerComponent() : finished(false), ghost(false), killed(false), startTime(0), elapsed(0),
-        jumpingSince(0), currentJump(0), oldNessBonus(0), coinSequenceBonus(1), totalCoinsEarned(0), index(-1) {
+    RunnerComponent() : playerOwner(0), collisionZone(0), session(0), finished(false), ghost(false), killed(false), startTime(0), elapsed(0),
+        jumpingSince(0), currentJump(0), oldNessBonus(0), coinSequenceBonus(1), jumpTrack(-1), totalCoinsEarned(0), coinCursor(-1), index(-1),
+        impulseLeft(0), holdForce(false), previousTickPosition(0.0f), tickPosition(0.0f), slot(-1) {
     }
-    Entity playerOwner, collisionZone;
+    Entity playerOwner, collisionZone, session;
     glm::vec2 startPoint, endPoint;
     Color color;
     float speed;
     bool finished, ghost, killed;
     float startTime, elapsed, jumpingSince;
     int currentJump, oldNessBonus, coinSequenceBonus;
-    std::vector<float> jumpTimes;
-    std::vector<float> jumpDurations;
+    // track in session's JumpTrackArena
+    int jumpTrack;
     int totalCoinsEarned;
-    std::vector<Entity> coins;
+    // coins picked, in pickup order (index in session coins)
+    std::vector<int> coins;
+    // the same as a bitset, and first coin in reach (see CoinSweep).
+    // Not saved: rebuilt from coins
+    std::vector<uint32_t> pickedCoins;
+    int coinCursor;
     int index;
+    // fixed timestep only: pending jump forces, and position at the last two ticks
+    // (transform holds the interpolated position)
+    float impulseLeft;
+    bool holdForce;
+    glm::vec2 previousTickPosition, tickPosition;
+    // Per-frame data (elapsed, jump timers, position, physics) is advanced by RunnerSystem in
+    // its RunnerKinematics, at this index; the fields above are a snapshot of it, written
+    // after each update. Not saved: slots are given again by rebuildPools
+    int slot;
 };
 
 #define theRunnerSystem RunnerSystem::GetInstance()
@@ -60,4 +68,41 @@ UPDATABLE_SYSTEM(Runner)
 public:
     static float MinJumpDuration;
     static float MaxJumpDuration;
+
+    // Runners (with their collision zone) and kill animations are pooled: they are
+    // instantiated before a session starts, and recycled when killed or at game end.
+    void preallocate(unsigned runnerCount);
+    // runner in its template state, with its collision zone
+    Entity spawnRunner();
+    void recycleRunner(Entity runner);
+    // recycles kill animations still playing
+    void recycleKillAnimations();
+    // after a state restore: pooled runners were saved as runners without session
+    // (kill animations aren't saved)
+    void rebuildPools();
+    // moves the collision zone to the runner position. AnchorSystem only runs once per
+    // frame: with a fixed timestep, zones are synced after every tick and when the tick
+    // positions are restored (see GameScene)
+    void syncCollisionZone(const RunnerComponent* rc, const TransformationComponent* tc);
+
+private:
+    Entity instantiateRunner();
+    // component -> slot, for runners just spawned or restored
+    void loadSlot(const RunnerComponent* rc);
+    // caches the current jump of the runner track in its slot
+    void refreshJump(const RunnerComponent* rc);
+    // end of a run: back to start point, as a ghost
+    void finishRunner(Entity runner, RunnerComponent* rc);
+    Entity instantiateKillAnimation();
+    void killRunner(Entity runner);
+
+    // hidden entities, ready to be reused (runners have no session)
+    std::vector<Entity> runnerPool, killAnimationPool;
+    // kill animations playing, with their remaining time
+    std::vector<std::pair<Entity, float> > killAnimations;
+    // runners killed, and runners advanced, during the current update (kept to avoid an
+    // allocation per update)
+    std::vector<Entity> killedRunners, advancedRunners;
+    // hot data of every runner entity (pooled ones are inactive), see RunnerComponent::slot
+    RunnerKinematics kinematics;
 };
@@ -32,6 +32,19 @@ SessionSystem::SessionSystem() : ComponentSystemImpl<SessionComponent>(HASH("Ses
     componentSerializer.add(new VectorProperty<Entity>(HASH("players", 0xa66fa23b), OFFSET(players, tc)));
     componentSerializer.add(new VectorProperty<Entity>(HASH("links", 0x54f52b4e), OFFSET(links, tc)));
     componentSerializer.add(new VectorProperty<Entity>(HASH("sparkling", 0x35cb46b9), OFFSET(sparkling, tc)));
+    componentSerializer.add(new Property<hash_t>(HASH("seed", 0xddb8b26f), OFFSET(seed, tc)));
+    componentSerializer.add(new Property<int>(HASH("level", 0x1dba6a20), OFFSET(level, tc)));
+    componentSerializer.add(new Property<int>(HASH("level_size", 0x9c5a5ec6), OFFSET(levelSize, tc)));
+    componentSerializer.add(new Property<bool>(HASH("streamed", 0x2c402461), OFFSET(streamed, tc)));
+    componentSerializer.add(new VectorProperty<float>(HASH("next_runner_start_time", 0x469844d), OFFSET(nextRunnerStartTime, tc)));
+    componentSerializer.add(new Property<int>(HASH("next_runner_start_time_index", 0x4a45b0ca), OFFSET(nextRunnerStartTimeIndex, tc)));
+    // the sequence goes on where it was (endless sessions keep drawing start times)
+    componentSerializer.add(new VectorProperty<uint32_t>(HASH("random_state", 0xc1d2c5c4), OFFSET(random.state, tc)));
+    componentSerializer.add(new Property<uint32_t>(HASH("random_index", 0x6073bbed), OFFSET(random.index, tc)));
+    componentSerializer.add(new Property<int>(HASH("jumps_per_track", 0xedfd0031), OFFSET(jumps.jumpsPerTrack, tc)));
+    componentSerializer.add(new Property<int>(HASH("jump_tracks_max", 0xa2600194), OFFSET(jumps.maxTracks, tc)));
+    componentSerializer.add(new VectorProperty<float>(HASH("jump_records", 0x81b6bb0d), OFFSET(jumps.records, tc)));
+    componentSerializer.add(new VectorProperty<int>(HASH("jump_counts", 0xe4a49d60), OFFSET(jumps.counts, tc)));
 }
 
 void SessionSystem::DoUpdate(float) {
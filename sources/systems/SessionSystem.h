@@ -21,20 +21,45 @@
 
 #include "base/Color.h"
 #include "systems/System.h"
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "../simulation/SessionRandom.h"
+#include "../simulation/JumpTrackArena.h"
+#include "../simulation/LevelChunks.h"
+#include "../util/RenderGroup.h"
 
 class Color;
 
 struct Statistics {
+    Statistics() : score(0) {}
+
+    // clears everything, with room for runnerCount runners
+    void reset(unsigned runnerCount) {
+        score = 0;
+        runner.assign(runnerCount, Runner());
+        color.assign(runnerCount, Color());
+    }
+    // endless sessions add runners as they go
+    void grow(unsigned runnerCount) {
+        if (runner.size() < runnerCount) {
+            runner.resize(runnerCount);
+            color.resize(runnerCount);
+        }
+    }
+
     int score;
     struct Runner {
+        Runner() : coinsCollected(0), lifetime(0), pointScored(0), killed(0), maxOldness(0), maxBonus(0) {}
         int coinsCollected;
         float lifetime;
         int pointScored;
         int killed;
         int maxOldness;
         int maxBonus;
-    } runner[10];
-    Color color[10];
+    };
+    std::vector<Runner> runner;
+    std::vector<Color> color;
 };
 
 struct Platform {
@@ -52,13 +77,35 @@ struct Platform {
 };
 
 struct SessionComponent {
-    SessionComponent() : numPlayers(1), currentRunner(0), userInputEnabled(true) {memset(&stats, 0 ,sizeof(Statistics));}
+    SessionComponent() : numPlayers(1), currentRunner(0), userInputEnabled(true), seed(0), level(0), levelSize(0), streamed(false), coinSize(0.0f), nextRunnerStartTimeIndex(0) {}
     unsigned numPlayers;
     Entity currentRunner;
     bool userInputEnabled;
     std::vector<Entity> runners, coins, players, links, sparkling, gains;
+    // coins of the whole level, left to right (coins[i] is at coinPositions[i], link[i] ends
+    // on it). Streamed levels only have entities (coin, gain, link and sparkling) for the
+    // chunks around the camera, 0 elsewhere: see RecursiveRunnerGame::streamLevel.
+    std::vector<glm::vec2> coinPositions;
     std::vector<Platform> platforms;
     Statistics stats;
+    // every session has its own random sequence and ghosts restart delays
+    hash_t seed;
+    int level;
+    // in screens
+    int levelSize;
+    bool streamed;
+    glm::vec2 coinSize;
+    SessionRandom random;
+    std::vector<float> nextRunnerStartTime;
+    int nextRunnerStartTimeIndex;
+    // jumps of every runner (see RunnerComponent::jumpTrack)
+    JumpTrackArena jumps;
+    // coins, links, platforms and runners, faded by GameScene. Entities joining it take
+    // its alpha (0 if the session starts with a transition). Not saved
+    RenderGroup renderGroup;
+    // streamed levels coins generator (see RecursiveRunnerGame::streamLevel). Not saved:
+    // started again by the first streamLevel after a restore
+    std::shared_ptr<LevelStreamer> streamer;
 };
 
 #define theSessionSystem SessionSystem::GetInstance()
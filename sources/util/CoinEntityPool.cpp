@@ -0,0 +1,127 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "CoinEntityPool.h"
+
+#include "base/EntityManager.h"
+#include "base/Log.h"
+
+#include "util/Random.h"
+
+static const struct {
+    hash_t name;
+    const char* templateName;
+} kinds[CoinEntity::Count] = {
+    { HASH("coin/coin", 0x38fb9dd5), "ingame/coin" },
+    { HASH("coin/gain", 0x99586161), "ingame/gain" },
+    { HASH("link/normal", 0xf4f248b8), "ingame/link" },
+    { HASH("link/particule", 0x5c2067ee), "ingame/link3" },
+};
+
+CoinEntityPool::CoinEntityPool() {
+}
+
+void CoinEntityPool::preallocate(CoinEntity::Enum kind, unsigned count) {
+    if (pool[kind].size() < count)
+        instantiate(kind, count - pool[kind].size());
+}
+
+void CoinEntityPool::instantiate(CoinEntity::Enum kind, unsigned count) {
+    EntityTemplateRef ref = theEntityManager.entityTemplateLibrary.load(kinds[kind].templateName);
+
+    pool[kind].reserve(pool[kind].size() + count);
+    for (unsigned i=0; i<count; i++) {
+        Entity e = theEntityManager.CreateEntity(kinds[kind].name, EntityType::Persistent, ref);
+        if (!templates[kind].captured) {
+            templates[kind].transform = *TRANSFORM(e);
+            if (kind == CoinEntity::Sparkling) {
+                templates[kind].anchor = *ANCHOR(e);
+            } else {
+                templates[kind].rendering = *RENDERING(e);
+            }
+            if (kind == CoinEntity::Coin || kind == CoinEntity::Sparkling) {
+                templates[kind].particule = *PARTICULE(e);
+            }
+            if (kind == CoinEntity::Gain) {
+                templates[kind].autoDestroy = *AUTO_DESTROY(e);
+            }
+            templates[kind].captured = true;
+        }
+        release(kind, e);
+    }
+}
+
+void CoinEntityPool::reset(CoinEntity::Enum kind, Entity e) const {
+    *TRANSFORM(e) = templates[kind].transform;
+    switch (kind) {
+        case CoinEntity::Coin:
+            *RENDERING(e) = templates[kind].rendering;
+            *PARTICULE(e) = templates[kind].particule;
+            // coin template rotation is an interval
+            TRANSFORM(e)->rotation = Random::Float(-0.1f, 0.1f);
+            break;
+        case CoinEntity::Gain:
+            *RENDERING(e) = templates[kind].rendering;
+            *AUTO_DESTROY(e) = templates[kind].autoDestroy;
+            break;
+        case CoinEntity::Link:
+            *RENDERING(e) = templates[kind].rendering;
+            break;
+        case CoinEntity::Sparkling:
+            *ANCHOR(e) = templates[kind].anchor;
+            *PARTICULE(e) = templates[kind].particule;
+            break;
+        default:
+            break;
+    }
+}
+
+EntitySpan CoinEntityPool::acquire(CoinEntity::Enum kind, unsigned count) {
+    if (pool[kind].size() < count) {
+        LOGW("Coin entity pool " << kind << " is too small: " << pool[kind].size() << " < " << count);
+        instantiate(kind, count - pool[kind].size());
+    }
+    acquired[kind].assign(pool[kind].end() - count, pool[kind].end());
+    pool[kind].resize(pool[kind].size() - count);
+
+    for (Entity e: acquired[kind]) {
+        reset(kind, e);
+    }
+    return EntitySpan(count ? &acquired[kind][0] : 0, count);
+}
+
+void CoinEntityPool::release(CoinEntity::Enum kind, Entity e) {
+    switch (kind) {
+        case CoinEntity::Coin:
+            RENDERING(e)->show = false;
+            PARTICULE(e)->emissionRate = 0;
+            break;
+        case CoinEntity::Gain:
+        case CoinEntity::Link:
+            RENDERING(e)->show = false;
+            break;
+        case CoinEntity::Sparkling:
+            PARTICULE(e)->emissionRate = 0;
+            ANCHOR(e)->parent = 0;
+            break;
+        default:
+            break;
+    }
+    pool[kind].push_back(e);
+}
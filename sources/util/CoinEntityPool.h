@@ -0,0 +1,92 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+
+#include "base/Entity.h"
+
+#include "systems/AnchorSystem.h"
+#include "systems/AutoDestroySystem.h"
+#include "systems/ParticuleSystem.h"
+#include "systems/RenderingSystem.h"
+#include "systems/TransformationSystem.h"
+
+namespace CoinEntity {
+    enum Enum {
+        Coin,
+        Gain,
+        Link,
+        // link particles, anchored to their link
+        Sparkling,
+        Count
+    };
+}
+
+// contiguous entities, handed out by CoinEntityPool::acquire
+struct EntitySpan {
+    EntitySpan(Entity* pEntities = 0, unsigned pCount = 0) : entities(pEntities), count(pCount) {}
+
+    Entity* begin() const { return entities; }
+    Entity* end() const { return entities + count; }
+    Entity operator[](unsigned i) const { return entities[i]; }
+
+    Entity* entities;
+    unsigned count;
+};
+
+/*
+ * Coins, gains and links entities are created in batches: each template is loaded once for
+ * the whole batch, and its first instance is captured. Released entities are hidden and
+ * reset to the captured state when acquired again, so streamed chunks and restarted games
+ * don't go through the entity templates anymore (same as RunnerSystem pools).
+ */
+class CoinEntityPool {
+    public:
+        CoinEntityPool();
+
+        // makes sure count entities of kind are pooled
+        void preallocate(CoinEntity::Enum kind, unsigned count);
+        // count entities of kind, in their template state. The span is valid until the
+        // next acquire of the same kind.
+        EntitySpan acquire(CoinEntity::Enum kind, unsigned count);
+        void release(CoinEntity::Enum kind, Entity e);
+
+    private:
+        void instantiate(CoinEntity::Enum kind, unsigned count);
+        void reset(CoinEntity::Enum kind, Entity e) const;
+
+        // Template state of each kind, captured from its first instance. Only the components
+        // of the kind template are used.
+        struct Template {
+            Template() : captured(false) {}
+
+            bool captured;
+            TransformationComponent transform;
+            RenderingComponent rendering;
+            ParticuleComponent particule;
+            AnchorComponent anchor;
+            AutoDestroyComponent autoDestroy;
+        } templates[CoinEntity::Count];
+        // hidden entities, ready to be reused
+        std::vector<Entity> pool[CoinEntity::Count];
+        // storage of the last span of each kind
+        std::vector<Entity> acquired[CoinEntity::Count];
+};
@@ -0,0 +1,52 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DecorLayout.h"
+
+#include <cstring>
+
+namespace DecorLayout {
+    // File layout (little endian):
+    //  - "RRDC", uint16 version, uint16 item count
+    //  - items
+    static const char Magic[4] = { 'R', 'R', 'D', 'C' };
+    static const uint16_t Version = 1;
+    static const unsigned HeaderSize = 8;
+    static_assert(sizeof(Item) == 44, "decor items are used in place");
+
+    const Item* items(const uint8_t* data, unsigned size, unsigned& count) {
+        count = 0;
+        if (!data || size < HeaderSize || memcmp(data, Magic, 4)
+            || reinterpret_cast<uintptr_t>(data + HeaderSize) % alignof(Item))
+            return 0;
+        uint16_t version, n;
+        memcpy(&version, data + 4, 2);
+        memcpy(&n, data + 6, 2);
+        if (version != Version || size != HeaderSize + n * sizeof(Item))
+            return 0;
+        const Item* result = reinterpret_cast<const Item*>(data + HeaderSize);
+        for (unsigned i=0; i<n; i++) {
+            // texture names are used as C strings
+            if (!memchr(result[i].texture, 0, sizeof(result[i].texture)) || result[i].parent > Parent::Trees)
+                return 0;
+        }
+        count = n;
+        return result;
+    }
+}
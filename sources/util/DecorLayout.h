@@ -0,0 +1,59 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Background decor, prebaked by tools/bake_decor.py: anchors are resolved offline, so items
+ * only need their gimp coordinates converted to screen ones at startup.
+ */
+namespace DecorLayout {
+    namespace Flag {
+        enum Enum {
+            Mirror = 1 << 0,
+            // building with smoke on its roof
+            Smoke = 1 << 1
+        };
+    }
+
+    namespace Parent {
+        enum Enum {
+            None,
+            Buildings,
+            Trees
+        };
+    }
+
+    // used in place: same layout as tools/bake_decor.py ITEM
+    struct Item {
+        // hash of "decor/<texture>"
+        uint32_t name;
+        char texture[16];
+        // center and size, in the 3840x800 decor gimp space (y axis pointing down)
+        float x, y, width, height;
+        float z;
+        uint8_t flags, parent;
+        uint16_t unused;
+    };
+
+    // items of a decor.layout file, or 0 if data isn't a valid one. Items point into data.
+    const Item* items(const uint8_t* data, unsigned size, unsigned& count);
+}
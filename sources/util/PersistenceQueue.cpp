@@ -0,0 +1,97 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PersistenceQueue.h"
+
+#include "base/Log.h"
+
+PersistenceQueue::PersistenceQueue() : storage(0), busy(false), quit(false) {
+}
+
+PersistenceQueue::~PersistenceQueue() {
+    stop();
+}
+
+void PersistenceQueue::start(StorageAPI* pStorage) {
+    stop();
+    storage = pStorage;
+    quit = false;
+#if !SAC_EMSCRIPTEN
+    worker = std::thread(&PersistenceQueue::workerLoop, this);
+#endif
+}
+
+void PersistenceQueue::stop() {
+#if !SAC_EMSCRIPTEN
+    if (worker.joinable()) {
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            quit = true;
+        }
+        wakeUp.notify_all();
+        // the worker empties the queue before leaving
+        worker.join();
+    }
+#endif
+    storage = 0;
+}
+
+void PersistenceQueue::push(const Write& write) {
+    LOGF_IF(!storage, "Persistence queue isn't started");
+#if SAC_EMSCRIPTEN
+    // no threads there
+    write(storage);
+#else
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        pending.push_back(write);
+    }
+    wakeUp.notify_one();
+#endif
+}
+
+void PersistenceQueue::flush() {
+#if !SAC_EMSCRIPTEN
+    std::unique_lock<std::mutex> l(mutex);
+    done.wait(l, [this] () -> bool { return pending.empty() && !busy; });
+#endif
+}
+
+void PersistenceQueue::workerLoop() {
+    while (true) {
+        Write write;
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            wakeUp.wait(l, [this] () -> bool { return quit || !pending.empty(); });
+            if (pending.empty())
+                return;
+            write = pending.front();
+            pending.pop_front();
+            busy = true;
+        }
+
+        write(storage);
+
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            busy = false;
+        }
+        done.notify_all();
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class StorageAPI;
+
+/*
+ * Write-behind queue for the game database: writes are queued by the game thread and run
+ * in order on a background thread, so game over and menu transitions never wait for the
+ * disk. Once started, every StorageAPI access must go through it. flush() blocks until
+ * every queued write is done (app paused, or exiting).
+ */
+class PersistenceQueue {
+    public:
+        typedef std::function<void (StorageAPI*)> Write;
+
+        PersistenceQueue();
+        ~PersistenceQueue();
+
+        void start(StorageAPI* storage);
+        // flushes, then stops the worker
+        void stop();
+
+        void push(const Write& write);
+        void flush();
+
+    private:
+        void workerLoop();
+
+    private:
+        StorageAPI* storage;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wakeUp, done;
+        // writes not run yet, and whether the worker is running one (under mutex)
+        std::deque<Write> pending;
+        bool busy, quit;
+};
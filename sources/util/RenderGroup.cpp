@@ -0,0 +1,61 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "RenderGroup.h"
+
+#include "systems/RenderingSystem.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// alpha steps smaller than a color channel unit aren't visible
+static const float AlphaStep = 1.0f / 255;
+
+RenderGroup::RenderGroup() : alpha(1), appliedAlpha(1) {
+}
+
+void RenderGroup::add(Entity e) {
+    RENDERING(e)->color.a = appliedAlpha;
+    members.push_back(e);
+}
+
+void RenderGroup::remove(Entity e) {
+    auto it = std::find(members.begin(), members.end(), e);
+    if (it != members.end()) {
+        *it = members.back();
+        members.pop_back();
+    }
+}
+
+void RenderGroup::clear() {
+    members.clear();
+}
+
+void RenderGroup::setAlpha(float a) {
+    alpha = a;
+    if (alpha == appliedAlpha)
+        return;
+    // always reach the ends of the fade
+    if (glm::abs(alpha - appliedAlpha) < AlphaStep && alpha != 0 && alpha != 1)
+        return;
+    appliedAlpha = alpha;
+    for (Entity e: members) {
+        RENDERING(e)->color.a = alpha;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+
+#include "base/Entity.h"
+
+/*
+ * Entities faded in and out together (the session coins, links, platforms and runners).
+ * The group alpha is only pushed to its members when it changes by a visible step, and
+ * entities joining the group take it at once, so entities created during a fade don't pop.
+ * Members alpha is the group alpha: they don't keep one of their own.
+ */
+class RenderGroup {
+    public:
+        RenderGroup();
+
+        void add(Entity e);
+        void remove(Entity e);
+        void clear();
+        bool empty() const { return members.empty(); }
+
+        void setAlpha(float alpha);
+        float getAlpha() const { return alpha; }
+
+    private:
+        std::vector<Entity> members;
+        float alpha;
+        // last alpha written to members
+        float appliedAlpha;
+};
@@ -0,0 +1,181 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ScoreHistory.h"
+
+#include "base/Log.h"
+
+#include "api/StorageAPI.h"
+
+#include <algorithm>
+#include <ctime>
+
+static const char* StagedScoreTable = "ScoreCompacted";
+static const char* StagedRollupTable = "ScoreRollupCompacted";
+// "1" while staged tables are being copied over the real ones
+static const char* PendingOption = "scoreCompactionPending";
+
+static ScoreRollup& findRollup(std::vector<ScoreRollup>& rollups, int period, int days) {
+    for (auto& r: rollups) {
+        if (r.period == period && r.days == days)
+            return r;
+    }
+    rollups.push_back(ScoreRollup(period, days));
+    return rollups.back();
+}
+
+static void merge(ScoreRollup& into, const ScoreRollup& r) {
+    into.games += r.games;
+    into.points += r.points;
+    into.coins += r.coins;
+    into.best = std::max(into.best, r.best);
+}
+
+template<class T, class Proxy>
+static std::vector<T> load(StorageAPI* storage, Proxy& proxy) {
+    storage->loadEntries(&proxy, "*", "");
+    std::vector<T> rows;
+    while (! proxy.isEmpty()) {
+        rows.push_back(proxy._queue.front());
+        proxy.popAnElement();
+    }
+    return rows;
+}
+
+template<class T, class Proxy>
+static void replaceAll(StorageAPI* storage, Proxy& proxy, const std::vector<T>& rows) {
+    storage->dropAll(&proxy);
+    for (const auto& r: rows) {
+        proxy._queue.push(r);
+    }
+    storage->saveEntries(&proxy);
+}
+
+// copies the staged tables over the real ones, then clears them
+static void commitStaged(StorageAPI* storage) {
+    ScoreStorageProxy staged(StagedScoreTable), ssp;
+    ScoreRollupStorageProxy stagedRollups(StagedRollupTable), srsp;
+    replaceAll(storage, ssp, load<Score>(storage, staged));
+    replaceAll(storage, srsp, load<ScoreRollup>(storage, stagedRollups));
+    storage->setOption(PendingOption, "0", "0");
+
+    storage->dropAll(&staged);
+    storage->dropAll(&stagedRollups);
+}
+
+int ScoreHistory::today() {
+    return time(0) / (24 * 3600);
+}
+
+bool ScoreHistory::compact(std::vector<Score>& scores, std::vector<ScoreRollup>& rollups, int today) {
+    bool changed = false;
+
+    if (scores.size() > KeptScores) {
+        std::stable_sort(scores.begin(), scores.end(), [] (const Score& a, const Score& b) -> bool {
+            return a.points > b.points;
+        });
+        unsigned kept = KeptScores;
+        for (unsigned i=KeptScores; i<scores.size(); i++) {
+            const Score& s = scores[i];
+            if (s.day >= today - RetentionDays) {
+                scores[kept++] = s;
+                continue;
+            }
+            // undated scores are rolled into the day of the compaction
+            add(findRollup(rollups, s.day ? s.day : today, 1), s);
+            changed = true;
+        }
+        scores.resize(kept);
+    }
+
+    // old days become weeks (findRollup may grow rollups, so iterate on indexes)
+    for (unsigned i=0; i<rollups.size(); ) {
+        const ScoreRollup r = rollups[i];
+        if (r.days == 1 && r.period < today - DailyRollupDays) {
+            rollups.erase(rollups.begin() + i);
+            merge(findRollup(rollups, r.period - r.period % 7, 7), r);
+            changed = true;
+        } else {
+            i++;
+        }
+    }
+    return changed;
+}
+
+void ScoreHistory::add(ScoreRollup& into, const Score& score) {
+    into.games++;
+    into.points += score.points;
+    into.coins += score.coins;
+    into.best = std::max(into.best, score.points);
+}
+
+ScoreRollup ScoreHistory::totals(const std::vector<Score>& scores, const std::vector<ScoreRollup>& rollups, int today) {
+    ScoreRollup t(today, 0);
+    for (const auto& s: scores) {
+        add(t, s);
+        if (s.day)
+            t.period = std::min(t.period, s.day);
+    }
+    for (const auto& r: rollups) {
+        merge(t, r);
+        t.period = std::min(t.period, r.period);
+    }
+    t.days = today - t.period + 1;
+    return t;
+}
+
+ScoreRollup ScoreHistory::loadTotals(StorageAPI* storage) {
+    ScoreStorageProxy ssp;
+    ScoreRollupStorageProxy srsp;
+    return totals(load<Score>(storage, ssp), load<ScoreRollup>(storage, srsp), today());
+}
+
+void ScoreHistory::recover(StorageAPI* storage) {
+    ScoreStorageProxy staged(StagedScoreTable);
+    ScoreRollupStorageProxy stagedRollups(StagedRollupTable);
+    storage->createTable(&staged);
+    storage->createTable(&stagedRollups);
+
+    storage->setOption(PendingOption, std::string(), "0");
+    if (storage->isOption(PendingOption, "1")) {
+        LOGW("Score history compaction was interrupted, finishing it");
+        commitStaged(storage);
+    }
+}
+
+void ScoreHistory::compactTables(StorageAPI* storage) {
+    ScoreStorageProxy ssp;
+    std::vector<Score> scores = load<Score>(storage, ssp);
+    ScoreRollupStorageProxy srsp;
+    std::vector<ScoreRollup> rollups = load<ScoreRollup>(storage, srsp);
+
+    const unsigned scoreCount = scores.size();
+    if (! compact(scores, rollups, today()))
+        return;
+    LOGI("Score history compacted: " << scoreCount << " scores -> " << scores.size() << " scores and " << rollups.size() << " rollups");
+
+    // the real tables are only dropped once the compacted ones are fully written
+    ScoreStorageProxy staged(StagedScoreTable);
+    ScoreRollupStorageProxy stagedRollups(StagedRollupTable);
+    replaceAll(storage, staged, scores);
+    replaceAll(storage, stagedRollups, rollups);
+    storage->setOption(PendingOption, "1", "0");
+
+    commitStaged(storage);
+}
@@ -0,0 +1,63 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "ScoreStorageProxy.h"
+
+#include <vector>
+
+class StorageAPI;
+
+/*
+ * Keeps the Score table bounded: the best scores and the recent ones are kept as they are,
+ * the others are rolled up into daily ScoreRollup rows (the day they were played), and
+ * daily rows older than a few weeks into weekly ones. Compaction runs at startup (see
+ * RecursiveRunnerGame::init). Rollups keep the history totals right (see totals, shown by
+ * StatsScene) once their scores are gone.
+ *
+ * StorageAPI has no transaction: compacted tables are first written to staging tables,
+ * then a pending flag is set and they're copied over the real ones. If the app is killed
+ * while copying, recover() copies them again at next startup.
+ */
+namespace ScoreHistory {
+    // more than TopScores needs
+    const unsigned KeptScores = 50;
+    // scores of the last RetentionDays days aren't rolled up
+    const int RetentionDays = 7;
+    const int DailyRollupDays = 28;
+
+    // days since epoch
+    int today();
+
+    // returns false if nothing changed
+    bool compact(std::vector<Score>& scores, std::vector<ScoreRollup>& rollups, int today);
+
+    // adds a game to a rollup
+    void add(ScoreRollup& into, const Score& score);
+    // every game ever played, kept scores and rolled up ones alike (period is the first day)
+    ScoreRollup totals(const std::vector<Score>& scores, const std::vector<ScoreRollup>& rollups, int today);
+    // same, from the tables. Must run after recover
+    ScoreRollup loadTotals(StorageAPI* storage);
+
+    // finishes an interrupted compaction. Must run before the Score table is read
+    void recover(StorageAPI* storage);
+    // loads, compacts and rewrites both tables (run by the persistence queue)
+    void compactTables(StorageAPI* storage);
+}
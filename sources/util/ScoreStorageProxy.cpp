@@ -20,27 +20,36 @@
 #include "ScoreStorageProxy.h"
 
 #include "base/Log.h"
-#include "base/ObjectSerializer.h"
 
-ScoreStorageProxy::ScoreStorageProxy() {
-    _tableName = "Score";
+static const StorageColumns<Score> columns({
+    StorageColumn<Score>("points", &Score::points),
+    StorageColumn<Score>("coins", &Score::coins),
+    StorageColumn<Score>("name", &Score::name),
+    StorageColumn<Score>("day", &Score::day),
+});
 
-    _columnsNameAndType["points"] = "int";
-    _columnsNameAndType["coins"] = "int";
-    _columnsNameAndType["name"] = "string";
+static const StorageColumns<ScoreRollup> rollupColumns({
+    StorageColumn<ScoreRollup>("period", &ScoreRollup::period),
+    StorageColumn<ScoreRollup>("days", &ScoreRollup::days),
+    StorageColumn<ScoreRollup>("games", &ScoreRollup::games),
+    StorageColumn<ScoreRollup>("points", &ScoreRollup::points),
+    StorageColumn<ScoreRollup>("coins", &ScoreRollup::coins),
+    StorageColumn<ScoreRollup>("best", &ScoreRollup::best),
+});
+
+ScoreStorageProxy::ScoreStorageProxy(const std::string& tableName) {
+    _tableName = tableName;
+
+    columns.declare(_columnsNameAndType);
 }
 
 std::string ScoreStorageProxy::getValue(const std::string& columnName) {
-    if (columnName == "points") {
-        return ObjectSerializer<int>::object2string(_queue.back().points);
-    } else if (columnName == "coins") {
-        return ObjectSerializer<int>::object2string(_queue.back().coins);
-    } else if (columnName == "name") {
-        return _queue.back().name;
-    } else {
+    const int c = cursor.index(columns, columnName);
+    if (c < 0) {
         LOGE("No such column name: " << columnName);
+        return "";
     }
-    return "";
+    return columns.get(_queue.front(), c);
 }
 
 void ScoreStorageProxy::setValue(const std::string& columnName, const std::string& value, bool pushNewElement) {
@@ -48,14 +57,38 @@ void ScoreStorageProxy::setValue(const std::string& columnName, const std::strin
         pushAnElement();
     }
 
-    if (columnName == "points") {
-        _queue.back().points =  ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "coins") {
-        _queue.back().coins = ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "name") {
-        _queue.back().name = value;
-    } else {
+    const int c = cursor.index(columns, columnName);
+    if (c < 0) {
+        LOGE("No such column name: " << columnName);
+        return;
+    }
+    columns.set(_queue.back(), c, value);
+}
+
+ScoreRollupStorageProxy::ScoreRollupStorageProxy(const std::string& tableName) {
+    _tableName = tableName;
+
+    rollupColumns.declare(_columnsNameAndType);
+}
+
+std::string ScoreRollupStorageProxy::getValue(const std::string& columnName) {
+    const int c = cursor.index(rollupColumns, columnName);
+    if (c < 0) {
         LOGE("No such column name: " << columnName);
+        return "";
     }
+    return rollupColumns.get(_queue.front(), c);
 }
 
+void ScoreRollupStorageProxy::setValue(const std::string& columnName, const std::string& value, bool pushNewElement) {
+    if (pushNewElement) {
+        pushAnElement();
+    }
+
+    const int c = cursor.index(rollupColumns, columnName);
+    if (c < 0) {
+        LOGE("No such column name: " << columnName);
+        return;
+    }
+    rollupColumns.set(_queue.back(), c, value);
+}
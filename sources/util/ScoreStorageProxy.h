@@ -20,6 +20,7 @@
 #pragma once
 
 #include "util/StorageProxy.h"
+#include "StorageColumns.h"
 
 #include <queue>
 #include <string>
@@ -29,17 +30,47 @@ struct Score {
     int points;
     int coins;
     std::string name;
+    // days since epoch (0 for scores saved before they were dated)
+    int day;
 
-    Score() {}
-    Score(int inScore, int inCoins, const std::string& inName) : points(inScore), coins(inCoins), name(inName) {}
+    Score() : points(0), coins(0), day(0) {}
+    Score(int inScore, int inCoins, const std::string& inName, int inDay = 0) : points(inScore), coins(inCoins), name(inName), day(inDay) {}
 };
 
 
 class ScoreStorageProxy : public StorageProxy<Score> {
     public:
-        ScoreStorageProxy();
+        ScoreStorageProxy(const std::string& tableName = "Score");
 
         std::string getValue(const std::string& columnName);
 
         void setValue(const std::string& columnName, const std::string& value, bool pushNewElement = false);
+
+    private:
+        StorageColumnCursor cursor;
+};
+
+// scores rolled up by ScoreHistory: days days starting at day period (days since epoch)
+struct ScoreRollup {
+    int period;
+    int days;
+    int games;
+    int points;
+    int coins;
+    int best;
+
+    ScoreRollup() {}
+    ScoreRollup(int inPeriod, int inDays) : period(inPeriod), days(inDays), games(0), points(0), coins(0), best(0) {}
+};
+
+class ScoreRollupStorageProxy : public StorageProxy<ScoreRollup> {
+    public:
+        ScoreRollupStorageProxy(const std::string& tableName = "ScoreRollup");
+
+        std::string getValue(const std::string& columnName);
+
+        void setValue(const std::string& columnName, const std::string& value, bool pushNewElement = false);
+
+    private:
+        StorageColumnCursor cursor;
 };
@@ -22,37 +22,34 @@
 #include "base/Log.h"
 #include "base/ObjectSerializer.h"
 
+typedef Statistics::Runner R;
+static const StorageColumns<R> columns({
+    StorageColumn<R>("coins", &R::coinsCollected),
+    StorageColumn<R>("lifetime", &R::lifetime),
+    StorageColumn<R>("points", &R::pointScored),
+    StorageColumn<R>("killed", &R::killed),
+    StorageColumn<R>("oldness", &R::maxOldness),
+    StorageColumn<R>("bonus", &R::maxBonus),
+});
+
 StatsStorageProxy::StatsStorageProxy(uint32_t id) : gameId(id) {
     _tableName = "Stats";
 
+    // same for every row
     _columnsNameAndType["game_id"] = "int";
-    _columnsNameAndType["coins"] = "int";
-    _columnsNameAndType["lifetime"] = "float";
-    _columnsNameAndType["points"] = "int";
-    _columnsNameAndType["killed"] = "int";
-    _columnsNameAndType["oldness"] = "int";
-    _columnsNameAndType["bonus"] = "int";
+    columns.declare(_columnsNameAndType);
 }
 
 std::string StatsStorageProxy::getValue(const std::string& columnName) {
-    if (columnName == "coins") {
-        return ObjectSerializer<int>::object2string(_queue.front().coinsCollected);
-    } else if (columnName == "game_id") {
+    if (columnName == "game_id") {
         return ObjectSerializer<int>::object2string(gameId);
-    } else if (columnName == "killed") {
-        return ObjectSerializer<int>::object2string(_queue.front().killed);
-    } else if (columnName == "oldness") {
-        return ObjectSerializer<int>::object2string(_queue.front().maxOldness);
-    } else if (columnName == "bonus") {
-        return ObjectSerializer<int>::object2string(_queue.front().maxBonus);
-    } else if (columnName == "points") {
-        return ObjectSerializer<int>::object2string(_queue.front().pointScored);
-    } else if (columnName == "lifetime") {
-        return ObjectSerializer<float>::object2string(_queue.front().lifetime);
-    } else {
+    }
+    const int c = cursor.index(columns, columnName);
+    if (c < 0) {
         LOGE("No such column name: " << columnName);
+        return "";
     }
-    return "";
+    return columns.get(_queue.front(), c);
 }
 
 void StatsStorageProxy::setValue(const std::string& columnName, const std::string& value, bool pushNewElement) {
@@ -60,20 +57,11 @@ void StatsStorageProxy::setValue(const std::string& columnName, const std::strin
         pushAnElement();
     }
 
-    if (columnName == "points") {
-        _queue.back().pointScored =  ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "killed") {
-        _queue.back().killed =  ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "coins") {
-        _queue.back().coinsCollected = ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "oldness") {
-        _queue.back().maxOldness = ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "bonus") {
-        _queue.back().maxBonus = ObjectSerializer<int>::string2object(value);
-    } else if (columnName == "lifetime") {
-        _queue.back().lifetime = ObjectSerializer<float>::string2object(value);
-    } else {
-        // LOGE("No such column name: " << columnName);
+    // game_id isn't loaded
+    if (columnName == "game_id")
+        return;
+    const int c = cursor.index(columns, columnName);
+    if (c >= 0) {
+        columns.set(_queue.back(), c, value);
     }
 }
-
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "util/StorageProxy.h"
+#include "StorageColumns.h"
 #include "systems/SessionSystem.h"
 
 
@@ -33,4 +34,5 @@ class StatsStorageProxy : public StorageProxy<Statistics::Runner> {
 
     private:
         uint32_t gameId;
+        StorageColumnCursor cursor;
 };
@@ -0,0 +1,162 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include "base/Log.h"
+
+/*
+ * Typed columns of a StorageProxy element. Each proxy declares its columns once (name, type
+ * and member); values are converted straight from/to their member, without a chain of
+ * string compares. StorageAPI still exchanges every value as a string.
+ */
+namespace StorageColumnType {
+    enum Enum {
+        Int,
+        Float,
+        String
+    };
+}
+
+template<class T>
+struct StorageColumn {
+    StorageColumn(const char* pName, int T::* member) :
+        name(pName), type(StorageColumnType::Int), intMember(member), floatMember(0), stringMember(0) {}
+    StorageColumn(const char* pName, float T::* member) :
+        name(pName), type(StorageColumnType::Float), intMember(0), floatMember(member), stringMember(0) {}
+    StorageColumn(const char* pName, std::string T::* member) :
+        name(pName), type(StorageColumnType::String), intMember(0), floatMember(0), stringMember(member) {}
+
+    const char* name;
+    StorageColumnType::Enum type;
+    int T::* intMember;
+    float T::* floatMember;
+    std::string T::* stringMember;
+};
+
+template<class T>
+class StorageColumns {
+    public:
+        StorageColumns(const std::vector<StorageColumn<T> >& pColumns) : columns(pColumns) {
+            for (unsigned i=0; i<columns.size(); i++) {
+                indexes[columns[i].name] = i;
+            }
+        }
+
+        // -1 if there's no such column
+        int index(const std::string& name) const {
+            auto it = indexes.find(name);
+            return (it == indexes.end()) ? -1 : it->second;
+        }
+
+        bool is(int column, const std::string& name) const {
+            return column >= 0 && name == columns[column].name;
+        }
+
+        // fills StorageProxy::_columnsNameAndType
+        void declare(std::map<std::string, std::string>& columnsNameAndType) const {
+            static const char* typeNames[] = { "int", "float", "string" };
+            for (const auto& c: columns) {
+                columnsNameAndType[c.name] = typeNames[c.type];
+            }
+        }
+
+        std::string get(const T& element, int column) const {
+            const StorageColumn<T>& c = columns[column];
+            char buffer[32];
+            switch (c.type) {
+                case StorageColumnType::Int:
+                    snprintf(buffer, sizeof(buffer), "%d", element.*c.intMember);
+                    return buffer;
+                case StorageColumnType::Float:
+                    // enough digits to read the same float back
+                    snprintf(buffer, sizeof(buffer), "%.9g", element.*c.floatMember);
+                    return buffer;
+                default:
+                    return element.*c.stringMember;
+            }
+        }
+
+        // malformed values are logged and read as 0 (empty ones, from NULL cells, silently)
+        void set(T& element, int column, const std::string& value) const {
+            const StorageColumn<T>& c = columns[column];
+            char* end = 0;
+            switch (c.type) {
+                case StorageColumnType::Int:
+                    element.*c.intMember = strtol(value.c_str(), &end, 10);
+                    break;
+                case StorageColumnType::Float:
+                    element.*c.floatMember = strtof(value.c_str(), &end);
+                    break;
+                default:
+                    element.*c.stringMember = value;
+                    return;
+            }
+            if (*end || (end == value.c_str() && !value.empty())) {
+                LOGW("Malformed value '" << value << "' in column " << c.name << ", read as "
+                    << (c.type == StorageColumnType::Int ? element.*c.intMember : element.*c.floatMember));
+            }
+        }
+
+    private:
+        std::vector<StorageColumn<T> > columns;
+        std::map<std::string, int> indexes;
+};
+
+/*
+ * StorageAPI asks for the columns of every row in the same order: a cursor learns that order
+ * on the first row, then each lookup only checks the column expected next (the index table
+ * is used again if the order changes). Unknown columns are skipped.
+ */
+class StorageColumnCursor {
+    public:
+        StorageColumnCursor() : next(0) {}
+
+        template<class T>
+        int index(const StorageColumns<T>& columns, const std::string& name) {
+            // next row
+            if (next == order.size() && !order.empty() && columns.is(order[0], name)) {
+                next = 0;
+            }
+            if (next < order.size()) {
+                if (columns.is(order[next], name)) {
+                    return order[next++];
+                }
+                order.clear();
+            }
+            // unknown columns aren't part of the order: they would make it grow with every row
+            const int c = columns.index(name);
+            if (c < 0)
+                return c;
+            order.push_back(c);
+            next = order.size();
+            return c;
+        }
+
+    private:
+        // column indexes, in StorageAPI order
+        std::vector<int> order;
+        unsigned next;
+};
@@ -0,0 +1,52 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "TopScores.h"
+
+#include <algorithm>
+
+TopScores::TopScores(unsigned pCapacity) : capacity(pCapacity) {
+    scores.reserve(capacity + 1);
+}
+
+void TopScores::load(ScoreStorageProxy& ssp) {
+    scores.clear();
+    while (! ssp.isEmpty()) {
+        insert(ssp._queue.front());
+        ssp.popAnElement();
+    }
+}
+
+unsigned TopScores::insert(const Score& score) {
+    const unsigned r = rank(score.points);
+    if (r < capacity) {
+        scores.insert(scores.begin() + r, score);
+        if (scores.size() > capacity)
+            scores.pop_back();
+    }
+    return r;
+}
+
+unsigned TopScores::rank(int points) const {
+    // scores are sorted by decreasing points
+    auto it = std::upper_bound(scores.begin(), scores.end(), points,
+        [] (int p, const Score& s) -> bool { return p > s.points; });
+    const unsigned r = it - scores.begin();
+    return (r < capacity) ? r : capacity;
+}
@@ -0,0 +1,55 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "ScoreStorageProxy.h"
+
+#include <vector>
+
+/*
+ * Best scores of the Score table, best first: loaded once at init, then kept up to
+ * date as scores are saved so the table is never queried again.
+ */
+class TopScores {
+    public:
+        static const unsigned DefaultCapacity = 10;
+
+        TopScores(unsigned capacity = DefaultCapacity);
+
+        // capacity best scores of the database
+        void load(ScoreStorageProxy& ssp);
+        // returns the rank of the new score (see rank)
+        unsigned insert(const Score& score);
+
+        // rank (0 is best) a score would have; equal scores rank after the existing ones.
+        // capacity() if it doesn't make it to the top
+        unsigned rank(int points) const;
+
+        bool empty() const { return scores.empty(); }
+        const Score& best() const { return scores.front(); }
+
+        unsigned size() const { return scores.size(); }
+        unsigned getCapacity() const { return capacity; }
+        const Score& operator[](unsigned i) const { return scores[i]; }
+
+    private:
+        unsigned capacity;
+        std::vector<Score> scores;
+};
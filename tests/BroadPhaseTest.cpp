@@ -0,0 +1,142 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Check.h"
+
+#include "simulation/SweepAndPrune.h"
+#include "simulation/IntervalTree.h"
+#include "simulation/SessionRandom.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/*
+ * SweepAndPrune and IntervalTree against brute force: both must report exactly the
+ * overlapping pairs (touching intervals included), whatever the intervals layout.
+ */
+struct Interval {
+    float min, max;
+};
+
+static bool overlap(const Interval& a, const Interval& b) {
+    return a.min <= b.max && b.min <= a.max;
+}
+
+// some intervals start exactly where one of touching ends, some are points
+static std::vector<Interval> randomIntervals(SessionRandom& random, int count, float width, float maxLength,
+    const std::vector<Interval>& touching = std::vector<Interval>()) {
+    std::vector<Interval> intervals(count);
+    for (int i=0; i<count; i++) {
+        if (i % 5 == 0 && !touching.empty())
+            intervals[i].min = touching[random.Int(0, touching.size() - 1)].max;
+        else
+            intervals[i].min = random.Float(-width, width);
+        intervals[i].max = intervals[i].min + ((i % 7) ? random.Float(0, maxLength) : 0);
+    }
+    return intervals;
+}
+
+static void testSweepAndPrune(SessionRandom& random, int countA, int countB, float maxLength) {
+    const std::vector<Interval> a = randomIntervals(random, countA, 20, maxLength);
+    const std::vector<Interval> b = randomIntervals(random, countB, 20, maxLength, a);
+
+    std::vector<std::pair<int, int> > expected;
+    for (int i=0; i<countA; i++) {
+        for (int j=0; j<countB; j++) {
+            if (overlap(a[i], b[j]))
+                expected.push_back(std::make_pair(i, j));
+        }
+    }
+
+    SweepAndPrune sweep;
+    // buffers are reused: the second call must give the same pairs
+    for (int pass=0; pass<2; pass++) {
+        sweep.clear();
+        for (int i=0; i<countA; i++)
+            sweep.add(0, a[i].min, a[i].max, i);
+        for (int j=0; j<countB; j++)
+            sweep.add(1, b[j].min, b[j].max, j);
+
+        std::vector<std::pair<int, int> > found;
+        sweep.findPairs([&found] (int i, int j) -> void {
+            found.push_back(std::make_pair(i, j));
+        });
+        std::sort(found.begin(), found.end());
+        CHECK(found == expected);
+    }
+}
+
+static void testIntervalTree(SessionRandom& random, int count, float maxLength) {
+    const std::vector<Interval> intervals = randomIntervals(random, count, 20, maxLength);
+
+    IntervalTree tree;
+    for (int i=0; i<count; i++)
+        tree.add(intervals[i].min, intervals[i].max, i);
+    tree.build();
+    CHECK(tree.empty() == (count == 0));
+
+    for (int q=0; q<200; q++) {
+        Interval query;
+        query.min = random.Float(-25, 25);
+        query.max = query.min + ((q % 5) ? random.Float(0, 4) : 0);
+        // queries touching an interval end
+        if (count > 0 && q % 4 == 1)
+            query.min = query.max = intervals[random.Int(0, count - 1)].max;
+        else if (count > 0 && q % 4 == 2)
+            query.max = query.min = intervals[random.Int(0, count - 1)].min;
+
+        std::vector<int> expected;
+        for (int i=0; i<count; i++) {
+            if (overlap(intervals[i], query))
+                expected.push_back(i);
+        }
+
+        std::vector<int> found;
+        float previousMin = -1e30f;
+        bool ordered = true;
+        tree.query(query.min, query.max, [&] (int id) -> void {
+            found.push_back(id);
+            ordered = ordered && intervals[id].min >= previousMin;
+            previousMin = intervals[id].min;
+        });
+        CHECK(ordered);
+        std::sort(found.begin(), found.end());
+        CHECK(found == expected);
+    }
+}
+
+int main() {
+    SessionRandom random(1234);
+
+    testSweepAndPrune(random, 0, 10, 1);
+    testSweepAndPrune(random, 10, 0, 1);
+    testSweepAndPrune(random, 1, 1, 40);
+    for (int i=0; i<50; i++) {
+        testSweepAndPrune(random, random.Int(1, 60), random.Int(1, 60), random.Float(0.1, 8));
+    }
+
+    testIntervalTree(random, 0, 1);
+    testIntervalTree(random, 1, 1);
+    for (int i=0; i<50; i++) {
+        testIntervalTree(random, random.Int(2, 300), random.Float(0.1, 8));
+    }
+
+    return Check::failures();
+}
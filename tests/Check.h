@@ -0,0 +1,44 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <iostream>
+#include <cmath>
+
+/*
+ * Minimal checks for the tests executables (no framework, so they build wherever the
+ * simulation code builds): CHECK logs failures and counts them, main returns the count.
+ */
+namespace Check {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl; \
+            Check::failures()++; \
+        } \
+    } while (0)
+
+#define CHECK_CLOSE(a, b, tolerance) CHECK(std::abs((a) - (b)) <= (tolerance))
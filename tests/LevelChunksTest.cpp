@@ -0,0 +1,107 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Check.h"
+
+#include "simulation/LevelChunks.h"
+#include "simulation/SessionRandom.h"
+
+#include <vector>
+#include <algorithm>
+
+/*
+ * Coins placement: sorted, spaced, within bounds, deterministic, and chunks don't depend
+ * on the order (or the thread) they're generated on.
+ */
+static void checkPlacement(SessionRandom& random, int count, float minX, float maxX, float spacing) {
+    std::vector<glm::vec2> coins(count);
+    LevelChunks::placeCoins(random, count, minX, maxX, spacing, -2, 2, &coins[0]);
+    for (int i=0; i<count; i++) {
+        CHECK(coins[i].x >= minX - 1e-3f);
+        CHECK(coins[i].x <= maxX + 1e-3f);
+        CHECK(coins[i].y >= -2 && coins[i].y < 2);
+        if (i > 0)
+            CHECK(coins[i].x - coins[i - 1].x >= spacing - 1e-3f);
+    }
+}
+
+int main() {
+    SessionRandom random(99);
+
+    for (int i=0; i<200; i++) {
+        const int count = random.Int(1, 200);
+        const float spacing = random.Float(0, 2);
+        const float minX = random.Float(-100, 100);
+        // from packed coins to plenty of room
+        const float maxX = minX + (count - 1) * spacing + random.Float(0, (i % 10) ? 100 : 0.01);
+        checkPlacement(random, count, minX, maxX, spacing);
+    }
+    checkPlacement(random, 100000, -1000, 200000, 1);
+
+    // every layout is equally likely: gaps are exchangeable, so each one takes 1 / (count + 1)
+    // of the slack on average (count = 4, slack = 10)
+    const int count = 4, draws = 20000;
+    double gaps[count + 1] = { 0 };
+    for (int d=0; d<draws; d++) {
+        glm::vec2 coins[count];
+        LevelChunks::placeCoins(random, count, 0, 13, 1, 0, 1, coins);
+        gaps[0] += coins[0].x;
+        for (int i=1; i<count; i++)
+            gaps[i] += coins[i].x - coins[i - 1].x - 1;
+        gaps[count] += 13 - coins[count - 1].x;
+    }
+    for (int i=0; i<=count; i++)
+        CHECK_CLOSE(gaps[i] / draws, 10.0 / (count + 1), 0.1);
+
+    // same seed, same level; chunks alone give the same coins
+    const LevelLayout layout(-30, 20, 12, 10, -1, 1);
+    const std::vector<glm::vec2> level = LevelChunks::generateCoins(1234, layout);
+    CHECK(level == LevelChunks::generateCoins(1234, layout));
+    CHECK(level != LevelChunks::generateCoins(1235, layout));
+    CHECK((int)level.size() == layout.coinCount());
+    for (unsigned i=1; i<level.size(); i++)
+        CHECK(level[i].x - level[i - 1].x >= 1 - 1e-3f);
+    CHECK(level.front().x >= layout.left + 1);
+    CHECK(level.back().x <= layout.right() - 1);
+    for (int c=layout.chunkCount - 1; c>=0; c--) {
+        std::vector<glm::vec2> chunk(layout.coinsPerChunk);
+        LevelChunks::generateCoins(1234, layout, c, &chunk[0]);
+        CHECK(std::equal(chunk.begin(), chunk.end(), level.begin() + c * layout.coinsPerChunk));
+        CHECK(layout.chunkAt(chunk.front().x) == c);
+    }
+
+    // background generation, requested out of order
+    LevelStreamer streamer;
+    streamer.start(1234, layout);
+    CHECK(streamer.isStarted(1234, layout));
+    for (int c=layout.chunkCount - 1; c>=0; c -= 2)
+        streamer.request(c);
+    std::vector<int> collected;
+    for (int c=0; c<layout.chunkCount; c++) {
+        streamer.request(c);
+        streamer.wait(c);
+        CHECK(std::equal(streamer.coins(c), streamer.coins(c) + layout.coinsPerChunk, level.begin() + c * layout.coinsPerChunk));
+    }
+    streamer.collect(collected);
+    std::sort(collected.begin(), collected.end());
+    CHECK((int)collected.size() == layout.chunkCount);
+    streamer.stop();
+
+    return Check::failures();
+}
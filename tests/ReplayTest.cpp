@@ -0,0 +1,149 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Check.h"
+
+#include "simulation/Replay.h"
+#include "simulation/SessionRandom.h"
+
+#include <cstdio>
+
+/*
+ * Replays written to an archive and read back: start times are drawn quantized, so they
+ * come back exactly, and jumps within half a tick.
+ */
+static ReplayData randomReplay(SessionRandom& random, uint32_t seed) {
+    ReplayData replay;
+    replay.seed = seed;
+    replay.level = random.Int(0, 2);
+    replay.score = random.Int(0, 100000);
+
+    const int runners = random.Int(1, 15);
+    for (int i=0; i<runners; i++) {
+        replay.runnerStartTimes.push_back(Replay::quantize(random.Float(0, 2)));
+    }
+    replay.jumps.init(runners);
+    for (int t=0; t<runners; t++) {
+        replay.jumps.createTrack();
+        float time = 0;
+        const int count = random.Int(0, JumpTrackArena::DefaultJumpsPerTrack);
+        for (int j=0; j<count; j++) {
+            time += random.Float(0, 0.5);
+            replay.jumps.push(t, time, random.Float(0.001, 0.2));
+        }
+    }
+    return replay;
+}
+
+static void checkSame(const ReplayData& expected, const ReplayData& actual, unsigned ticksPerSecond) {
+    const float tolerance = 0.5f / ticksPerSecond + 1e-4f;
+
+    CHECK(actual.seed == expected.seed);
+    CHECK(actual.level == expected.level);
+    CHECK(actual.score == expected.score);
+    CHECK(actual.runnerStartTimes.size() == expected.runnerStartTimes.size());
+    for (unsigned i=0; i<actual.runnerStartTimes.size() && i<expected.runnerStartTimes.size(); i++) {
+        if (ticksPerSecond == Replay::DefaultTicksPerSecond)
+            CHECK(actual.runnerStartTimes[i] == expected.runnerStartTimes[i]);
+        else
+            CHECK_CLOSE(actual.runnerStartTimes[i], expected.runnerStartTimes[i], tolerance);
+    }
+    CHECK(actual.jumps.trackCount() == expected.jumps.trackCount());
+    for (int t=0; t<actual.jumps.trackCount() && t<expected.jumps.trackCount(); t++) {
+        CHECK(actual.jumps.size(t) == expected.jumps.size(t));
+        for (int j=0; j<actual.jumps.size(t) && j<expected.jumps.size(t); j++) {
+            // jump starts are stored as deltas: the error must not add up along the track
+            CHECK_CLOSE(actual.jumps.time(t, j), expected.jumps.time(t, j), tolerance);
+            CHECK_CLOSE(actual.jumps.duration(t, j), expected.jumps.duration(t, j), tolerance);
+        }
+    }
+}
+
+int main() {
+    SessionRandom random(42);
+
+    std::vector<ReplayData> replays;
+    ReplayArchiveWriter writer;
+    for (int i=0; i<200; i++) {
+        replays.push_back(randomReplay(random, 1000 + i));
+        writer.add(replays.back());
+    }
+    CHECK(writer.count() == replays.size());
+
+    // in memory
+    std::vector<uint8_t> bytes = writer.bytes();
+    ReplayArchive archive;
+    CHECK(archive.open(&bytes[0], bytes.size()));
+    CHECK(archive.count() == replays.size());
+    CHECK(archive.ticksPerSecond() == Replay::DefaultTicksPerSecond);
+    for (unsigned i=0; i<archive.count(); i++) {
+        // index is readable without decoding
+        CHECK(archive.entry(i).seed == replays[i].seed);
+        CHECK(archive.entry(i).score == replays[i].score);
+
+        ReplayData replay;
+        CHECK(archive.read(i, replay));
+        checkSame(replays[i], replay, Replay::DefaultTicksPerSecond);
+    }
+
+    // through a file
+    const char* path = "replays-test.bin";
+    CHECK(writer.save(path));
+    ReplayArchive mapped;
+    CHECK(mapped.open(path));
+    CHECK(mapped.count() == replays.size());
+    for (unsigned i=0; i<mapped.count(); i++) {
+        ReplayData replay;
+        CHECK(mapped.read(i, replay));
+        checkSame(replays[i], replay, Replay::DefaultTicksPerSecond);
+    }
+    mapped.close();
+    remove(path);
+
+    // copies, as is and at another tick rate
+    ReplayArchiveWriter same, coarser(60);
+    for (unsigned i=0; i<archive.count(); i += 7) {
+        same.add(archive, i);
+        coarser.add(archive, i);
+    }
+    std::vector<uint8_t> sameBytes = same.bytes(), coarserBytes = coarser.bytes();
+    ReplayArchive sameArchive, coarserArchive;
+    CHECK(sameArchive.open(&sameBytes[0], sameBytes.size()));
+    CHECK(coarserArchive.open(&coarserBytes[0], coarserBytes.size()));
+    CHECK(coarserArchive.ticksPerSecond() == 60);
+    for (unsigned i=0; i<sameArchive.count(); i++) {
+        ReplayData a, b;
+        CHECK(sameArchive.read(i, a));
+        CHECK(coarserArchive.read(i, b));
+        checkSame(replays[i * 7], a, Replay::DefaultTicksPerSecond);
+        checkSame(a, b, 60);
+    }
+
+    // damaged archives are rejected
+    CHECK(!ReplayArchive().open(&bytes[0], 10));
+    std::vector<uint8_t> damaged(bytes);
+    damaged[0] = 'X';
+    CHECK(!ReplayArchive().open(&damaged[0], damaged.size()));
+    // first index entry payload offset (after the 16 bytes header, seed and score) out of the file
+    damaged = bytes;
+    damaged[16 + 8 + 3] = 0xff;
+    CHECK(!ReplayArchive().open(&damaged[0], damaged.size()));
+
+    return Check::failures();
+}
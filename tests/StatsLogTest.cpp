@@ -0,0 +1,195 @@
+/*
+    This file is part of RecursiveRunner.
+
+    @author Soupe au Caillou - Jordane Pelloux-Prayer
+    @author Soupe au Caillou - Gautier Pelloux-Prayer
+    @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+
+    RecursiveRunner is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 3.
+
+    RecursiveRunner is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Check.h"
+
+#include "simulation/StatsLog.h"
+#include "simulation/SessionRandom.h"
+#include "systems/SessionSystem.h"
+
+#include <cstdio>
+#include <algorithm>
+
+/*
+ * Statistics logged and read back column by column, over several blocks, then logs damaged
+ * the way a crash would leave them.
+ */
+struct Rows {
+    std::vector<int32_t> columns[StatsColumn::Count];
+};
+
+static void addGame(SessionRandom& random, StatsLogWriter& writer, Rows& rows, uint32_t time) {
+    Statistics stats;
+    const int runners = random.Int(1, 15);
+    const int level = random.Int(0, 2);
+    stats.reset(runners);
+    stats.score = random.Int(0, 50000);
+    for (int i=0; i<runners; i++) {
+        Statistics::Runner& r = stats.runner[i];
+        r.coinsCollected = random.Int(0, 40);
+        // lifetimes are stored in ticks
+        r.lifetime = random.Int(0, 9000) / (float)StatsLog::LifetimeTicksPerSecond;
+        // killed runners lose points
+        r.pointScored = random.Int(-2000, 20000);
+        r.killed = random.Int(0, 3);
+        r.maxOldness = random.Int(0, 10);
+        r.maxBonus = random.Int(1, 20);
+
+        rows.columns[StatsColumn::Time].push_back(time);
+        rows.columns[StatsColumn::Level].push_back(level);
+        rows.columns[StatsColumn::Score].push_back(stats.score);
+        rows.columns[StatsColumn::Runner].push_back(i);
+        rows.columns[StatsColumn::Coins].push_back(r.coinsCollected);
+        rows.columns[StatsColumn::Lifetime].push_back((int32_t)(r.lifetime * StatsLog::LifetimeTicksPerSecond + 0.5f));
+        rows.columns[StatsColumn::Points].push_back(r.pointScored);
+        rows.columns[StatsColumn::Killed].push_back(r.killed);
+        rows.columns[StatsColumn::Oldness].push_back(r.maxOldness);
+        rows.columns[StatsColumn::Bonus].push_back(r.maxBonus);
+    }
+    writer.add(stats, level, time);
+}
+
+static std::vector<uint8_t> encodeGames(SessionRandom& random, int games, Rows& rows) {
+    StatsLogWriter writer;
+    for (int g=0; g<games; g++) {
+        addGame(random, writer, rows, 1700000000 + g * 60);
+    }
+    std::vector<uint8_t> out;
+    writer.encode(out);
+    CHECK(writer.pendingRows() == 0);
+    return out;
+}
+
+static void checkColumns(const StatsLogReader& reader, const Rows& rows) {
+    CHECK(reader.rowCount() == rows.columns[0].size());
+    for (int c=0; c<StatsColumn::Count; c++) {
+        std::vector<int32_t> values;
+        reader.column((StatsColumn::Enum)c, values);
+        CHECK(values == rows.columns[c]);
+
+        // same values, block by block
+        std::vector<int32_t> streamed, block(StatsLog::BlockRows);
+        for (unsigned b=0; b<reader.blockCount(); b++) {
+            const unsigned count = reader.column((StatsColumn::Enum)c, b, &block[0]);
+            CHECK(count <= StatsLog::BlockRows);
+            streamed.insert(streamed.end(), block.begin(), block.begin() + count);
+        }
+        CHECK(streamed == rows.columns[c]);
+    }
+}
+
+static void append(Rows& to, const Rows& from) {
+    for (int c=0; c<StatsColumn::Count; c++)
+        to.columns[c].insert(to.columns[c].end(), from.columns[c].begin(), from.columns[c].end());
+}
+
+int main() {
+    SessionRandom random(7);
+
+    // round trip, over several blocks
+    Rows rows;
+    const std::vector<uint8_t> log = encodeGames(random, 2000, rows);
+    StatsLogReader reader;
+    CHECK(reader.open(&log[0], log.size()));
+    CHECK(reader.blockCount() == (rows.columns[0].size() + StatsLog::BlockRows - 1) / StatsLog::BlockRows);
+    CHECK(reader.validSize() == log.size());
+    checkColumns(reader, rows);
+
+    // aggregates against plain loops
+    std::vector<int32_t> points(rows.columns[StatsColumn::Points]), sorted(points);
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(StatsLog::percentile(points, 0) == sorted.front());
+    CHECK(StatsLog::percentile(points, 0.5f) == sorted[(sorted.size() + 1) / 2 - 1]);
+    CHECK(StatsLog::percentile(points, 1) == sorted.back());
+
+    std::vector<double> means, streamedMeans;
+    StatsLog::meanPerRunner(rows.columns[StatsColumn::Points], rows.columns[StatsColumn::Runner], means);
+    StatsLog::RunnerMeans runnerMeans;
+    std::vector<int32_t> values(StatsLog::BlockRows), runners(StatsLog::BlockRows);
+    for (unsigned b=0; b<reader.blockCount(); b++) {
+        const unsigned count = reader.column(StatsColumn::Points, b, &values[0]);
+        reader.column(StatsColumn::Runner, b, &runners[0]);
+        runnerMeans.add(&values[0], &runners[0], count);
+    }
+    runnerMeans.means(streamedMeans);
+    CHECK(means == streamedMeans);
+    for (unsigned r=0; r<means.size(); r++) {
+        double sum = 0;
+        unsigned count = 0;
+        for (unsigned i=0; i<rows.columns[StatsColumn::Runner].size(); i++) {
+            if (rows.columns[StatsColumn::Runner][i] == (int)r) {
+                sum += rows.columns[StatsColumn::Points][i];
+                count++;
+            }
+        }
+        CHECK_CLOSE(means[r], sum / count, 1e-6);
+    }
+
+    // three appends: a, b, c
+    Rows rowsA, rowsB, rowsC;
+    const std::vector<uint8_t> a = encodeGames(random, 10, rowsA);
+    const std::vector<uint8_t> b = encodeGames(random, 10, rowsB);
+    const std::vector<uint8_t> c = encodeGames(random, 10, rowsC);
+    Rows rowsAC(rowsA);
+    append(rowsAC, rowsC);
+
+    // b cut in the middle: the reader resyncs on c
+    std::vector<uint8_t> torn(a);
+    torn.insert(torn.end(), b.begin(), b.begin() + b.size() / 2);
+    torn.insert(torn.end(), c.begin(), c.end());
+    StatsLogReader tornReader;
+    tornReader.open(&torn[0], torn.size());
+    CHECK(tornReader.blockCount() == 2);
+    checkColumns(tornReader, rowsAC);
+
+    // b damaged: its checksum doesn't match
+    std::vector<uint8_t> damaged(a);
+    damaged.insert(damaged.end(), b.begin(), b.end());
+    damaged.insert(damaged.end(), c.begin(), c.end());
+    damaged[a.size() + b.size() - 3] ^= 0x55;
+    StatsLogReader damagedReader;
+    damagedReader.open(&damaged[0], damaged.size());
+    CHECK(damagedReader.blockCount() == 2);
+    checkColumns(damagedReader, rowsAC);
+
+    // file ending with a cut block: appending drops it first
+    const char* path = "stats-test.log";
+    FILE* file = fopen(path, "wb");
+    CHECK(file);
+    if (file) {
+        fwrite(&a[0], a.size(), 1, file);
+        fwrite(&b[0], b.size() - 7, 1, file);
+        fclose(file);
+    }
+    StatsLogWriter writer;
+    Rows appended(rowsA);
+    addGame(random, writer, appended, 1800000000);
+    CHECK(writer.append(path));
+    addGame(random, writer, appended, 1800000060);
+    CHECK(writer.append(path));
+    StatsLogReader fileReader;
+    CHECK(fileReader.open(path));
+    CHECK(fileReader.blockCount() == 3);
+    CHECK(fileReader.validSize() == fileReader.byteCount());
+    checkColumns(fileReader, appended);
+    fileReader.close();
+    remove(path);
+
+    return Check::failures();
+}
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+#
+#   This file is part of RecursiveRunner.
+#
+#   @author Soupe au Caillou - Jordane Pelloux-Prayer
+#   @author Soupe au Caillou - Gautier Pelloux-Prayer
+#   @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+#
+#   RecursiveRunner is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, version 3.
+#
+#   RecursiveRunner is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""Builds assets/decor.layout, the menu and game background decor.
+
+Decor items are placed in a 3840x800 gimp space (three screens). Their anchor
+(cardinal) is resolved with the texture sizes, so the game only converts gimp
+coordinates to screen ones at startup (see RecursiveRunnerGame::decor).
+
+The file is read in place by DecorLayout::items (sources/util/DecorLayout.cpp),
+so its layout must match.
+
+Usage: tools/bake_decor.py [--dump]
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from extract_collision_zones import ROOT, murmur_hash
+
+MAGIC = b'RRDC'
+VERSION = 1
+
+# DecorLayout::Flag
+MIRROR, SMOKE = 1, 2
+# DecorLayout::Parent
+NONE, BUILDINGS, TREES = 0, 1, 2
+
+# gimp x, gimp y, z, cardinal of (x, y), texture, mirrored, parent
+DECOR = [
+    # buildings
+    (554, 149, 0.2, 'NE', 'immeuble', False, BUILDINGS),
+    (1690, 149, 0.2, 'NE', 'immeuble', False, BUILDINGS),
+    (3173, 139, 0.2, 'NW', 'immeuble', False, BUILDINGS),
+    (358, 404, 0.25, 'NW', 'maison', True, BUILDINGS),
+    (2097, 400, 0.25, 'NE', 'maison', False, BUILDINGS),
+    (2053, 244, 0.29, 'NW', 'usine_desaf', False, BUILDINGS),
+    (3185, 298, 0.22, 'NE', 'usine2', True, BUILDINGS),
+    # trees
+    (152, 780, 0.5, 'S', 'arbre3', False, TREES),
+    (522, 780, 0.5, 'S', 'arbre2', False, TREES),
+    (812, 774, 0.45, 'S', 'arbre5', False, TREES),
+    (1162, 792, 0.5, 'S', 'arbre4', False, TREES),
+    (1418, 790, 0.45, 'S', 'arbre2', False, TREES),
+    (1600, 768, 0.42, 'S', 'arbre1', False, TREES),
+    (1958, 782, 0.5, 'S', 'arbre4', True, TREES),
+    (2396, 774, 0.44, 'S', 'arbre5', False, TREES),
+    (2684, 784, 0.45, 'S', 'arbre3', False, TREES),
+    (3022, 764, 0.42, 'S', 'arbre1', False, TREES),
+    (3290, 764, 0.41, 'S', 'arbre1', True, TREES),
+    (3538, 768, 0.44, 'S', 'arbre2', False, TREES),
+    (3820, 772, 0.5, 'S', 'arbre4', False, TREES),
+    # benchs
+    (672, 768, 0.35, 'S', 'bench_cat', False, TREES),
+    (1090, 764, 0.35, 'S', 'bench', False, TREES),
+    (2082, 760, 0.35, 'S', 'bench', True, TREES),
+    (2526, 762, 0.35, 'S', 'bench', False, TREES),
+    (3464, 758, 0.35, 'S', 'bench_cat', False, TREES),
+    (3612, 762, 0.6, 'S', 'bench', False, TREES),
+    # lampadaire
+    (472, 748, 0.3, 'S', 'lampadaire2', False, TREES),
+    (970, 748, 0.3, 'S', 'lampadaire3', False, TREES),
+    (1740, 748, 0.3, 'S', 'lampadaire2', False, TREES),
+    (2208, 748, 0.3, 'S', 'lampadaire1', False, TREES),
+    (2620, 748, 0.3, 'S', 'lampadaire3', False, TREES),
+    (3182, 748, 0.3, 'S', 'lampadaire1', False, TREES),
+    (3732, 748, 0.3, 'S', 'lampadaire3', False, TREES),
+]
+# the first buildings smoke
+SMOKING = 3
+
+# uint32 name hash, char[16] texture, center x, center y, width, height, z, uint8 flags, uint8 parent, 2 unused bytes
+ITEM = struct.Struct('<I16s5fBBxx')
+
+
+def texture_size(folder, texture):
+    """Size of an unprepared texture, as returned by RenderingSystem::getTextureSize"""
+    for sub in sorted(os.listdir(folder)):
+        path = os.path.join(folder, sub, texture + '.png')
+        if os.path.exists(path):
+            with open(path, 'rb') as f:
+                header = f.read(24)
+            if header[:8] != b'\x89PNG\r\n\x1a\n':
+                raise ValueError('%s: not a png' % path)
+            return struct.unpack('>II', header[16:24])
+    raise ValueError('%s: texture not found in %s' % (texture, folder))
+
+
+def center(x, y, width, height, cardinal):
+    """Center of a box whose cardinal point is (x, y), gimp y axis pointing down"""
+    if 'E' in cardinal:
+        x -= width * 0.5
+    elif 'W' in cardinal:
+        x += width * 0.5
+    if 'N' in cardinal:
+        y += height * 0.5
+    elif 'S' in cardinal:
+        y -= height * 0.5
+    return x, y
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--input', default=os.path.join(ROOT, 'datas', 'textures', 'unprepared_assets'))
+    parser.add_argument('--output', default=os.path.join(ROOT, 'assets', 'decor.layout'))
+    parser.add_argument('--dump', action='store_true', help='print items')
+    args = parser.parse_args()
+
+    out = struct.pack('<4sHH', MAGIC, VERSION, len(DECOR))
+    for i, (x, y, z, cardinal, texture, mirrored, parent) in enumerate(DECOR):
+        if len(texture) >= 16:
+            raise ValueError('%s: texture name too long' % texture)
+        width, height = texture_size(args.input, texture)
+        cx, cy = center(x, y, width, height, cardinal)
+        flags = (MIRROR if mirrored else 0) | (SMOKE if i < SMOKING else 0)
+        if args.dump:
+            print('%s: center=%.1f,%.1f size=%d,%d z=%.2f flags=%d parent=%d' % (texture, cx, cy, width, height, z, flags, parent))
+        out += ITEM.pack(murmur_hash('decor/' + texture), texture.encode(), cx, cy, width, height, z, flags, parent)
+
+    with open(args.output, 'wb') as f:
+        f.write(out)
+    print('%s: %d items, %d bytes' % (os.path.relpath(args.output), len(DECOR), len(out)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+#
+#   This file is part of RecursiveRunner.
+#
+#   @author Soupe au Caillou - Jordane Pelloux-Prayer
+#   @author Soupe au Caillou - Gautier Pelloux-Prayer
+#   @author Soupe au Caillou - Pierre-Eric Pelloux-Prayer
+#
+#   RecursiveRunner is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, version 3.
+#
+#   RecursiveRunner is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with RecursiveRunner.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""Builds assets/runner.collision from the runner frames alpha masks.
+
+An oriented box is fitted to each frame: its orientation is the main axis of
+the opaque pixels, kept within the rotations of the hand-tuned zones, and its
+extent along each axis drops a fraction of those pixels (arms and legs) so the
+box only covers the body. Default fractions are the ones whose boxes sizes are
+the closest to the hand-tuned ones (see --calibrate), and --compare shows how
+far each zone is from its hand-tuned version.
+
+The table is read in place by RunnerCollision::use (sources/simulation/
+CollisionZone.cpp), so its layout must match. Zones are relative to the
+sprite size, which makes the table valid for every dpi. The game only loads
+it when param::FittedCollisionZones is set: hand-tuned zones stay the
+default until fitted ones are play-tested.
+
+Usage: tools/extract_collision_zones.py [--trim-width 0.24] [--dump | --compare | --calibrate]
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import zlib
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+# same order as RunnerCollision::Textures
+FRAMES = ['jump_l2r_%04d' % i for i in range(17)] + ['run_l2r_%04d' % i for i in range(12)]
+
+# built-in zones of sources/simulation/CollisionZone.cpp (JUMP_ZONES then RUN_ZONE), in
+# pixels of the 200x210 sprites: x, y, width, height, rotation. Keep them in sync.
+HAND_TUNED = [
+    (90, 52, 28, 84, -0.1), (91, 62, 27, 78, -0.1), (95, 74, 23, 72, -0.1), (95, 74, 23, 70, -0.1),
+    (111, 95, 24, 75, -0.3), (114, 94, 15, 84, -0.5), (109, 100, 20, 81, -0.5), (101, 96, 24, 85, -0.2),
+    (100, 98, 25, 74, -0.15), (95, 95, 25, 76, 0.0), (88, 96, 25, 75, 0.), (85, 95, 24, 83, 0.4),
+    (93, 100, 24, 83, 0.2), (110, 119, 25, 64, -0.6), (100, 120, 21, 60, -0.2), (105, 115, 22, 62, -0.15),
+    (103, 103, 24, 66, -0.1),
+] + [(118, 103, 35, 88, -0.5)] * 12
+# fitted rotations are kept in this range
+ANGLE_RANGE = (min(z[4] for z in HAND_TUNED), max(z[4] for z in HAND_TUNED))
+
+MAGIC = b'RRCZ'
+VERSION = 1
+
+
+def murmur_hash(name, seed=0x12345678):
+    """MurmurHash2, as used by sac's HASH macro"""
+    data = bytearray(name.encode())
+    m = 0x5bd1e995
+    h = (seed ^ len(data)) & 0xffffffff
+    i = 0
+    while len(data) - i >= 4:
+        k = int.from_bytes(data[i:i + 4], 'little')
+        k = (k * m) & 0xffffffff
+        k ^= k >> 24
+        k = (k * m) & 0xffffffff
+        h = ((h * m) & 0xffffffff) ^ k
+        i += 4
+    left = len(data) - i
+    if left == 3:
+        h ^= data[i + 2] << 16
+    if left >= 2:
+        h ^= data[i + 1] << 8
+    if left >= 1:
+        h ^= data[i]
+        h = (h * m) & 0xffffffff
+    h ^= h >> 13
+    h = (h * m) & 0xffffffff
+    h ^= h >> 15
+    return h
+
+
+def read_alpha(path):
+    """Returns (width, height, rows of alpha values) of a 8 bits RGBA png"""
+    with open(path, 'rb') as f:
+        content = f.read()
+    if content[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s: not a png' % path)
+    pos, idat = 8, b''
+    while pos < len(content):
+        length, kind = struct.unpack('>I4s', content[pos:pos + 8])
+        chunk = content[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+            if depth != 8 or color != 6 or interlace:
+                raise ValueError('%s: only non interlaced 8 bits RGBA is supported' % path)
+        elif kind == b'IDAT':
+            idat += chunk
+    raw = zlib.decompress(idat)
+
+    bpp, stride = 4, width * 4
+    rows, previous, offset = [], bytearray(stride), 0
+    for _ in range(height):
+        kind = raw[offset]
+        line = bytearray(raw[offset + 1:offset + 1 + stride])
+        offset += 1 + stride
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = previous[i]
+            c = previous[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xff
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xff
+            elif kind == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xff
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xff
+        rows.append(line[3::4])
+        previous = line
+    return width, height, rows
+
+
+class Body:
+    """Opaque pixels of a frame, projected on their main axes (clamped to ANGLE_RANGE)"""
+
+    def __init__(self, width, height, rows, threshold):
+        points = [(x + 0.5, y + 0.5) for y in range(height) for x in range(width) if rows[y][x] >= threshold]
+        if not points:
+            raise ValueError('empty alpha mask')
+        n = float(len(points))
+        self.mx = sum(p[0] for p in points) / n
+        self.my = sum(p[1] for p in points) / n
+        sxx = sum((p[0] - self.mx) ** 2 for p in points) / n
+        syy = sum((p[1] - self.my) ** 2 for p in points) / n
+        sxy = sum((p[0] - self.mx) * (p[1] - self.my) for p in points) / n
+        # angle from the vertical to the main axis, towards +x (image y axis points down).
+        # Running poses spread the legs so much that the main axis may lie down: the
+        # rotation is limited to the hand-tuned ones
+        self.angle = min(max(0.5 * math.atan2(2 * sxy, syy - sxx), ANGLE_RANGE[0]), ANGLE_RANGE[1])
+        self.c, self.s = math.cos(self.angle), math.sin(self.angle)
+        c, s = self.c, self.s
+        self.across = sorted((x - self.mx) * c - (y - self.my) * s for x, y in points)
+        self.along = sorted((x - self.mx) * s + (y - self.my) * c for x, y in points)
+
+    def box(self, trim_width, trim_height):
+        """Oriented box (center x, center y, width, height, angle) in pixels, y down"""
+        def extent(values, trim):
+            last = len(values) - 1
+            return values[int(trim * last)], values[int((1 - trim) * last)]
+
+        u0, u1 = extent(self.across, trim_width)
+        v0, v1 = extent(self.along, trim_height)
+        cu, cv = (u0 + u1) * 0.5, (v0 + v1) * 0.5
+        c, s = self.c, self.s
+        return self.mx + cu * c + cv * s, self.my - cu * s + cv * c, u1 - u0, v1 - v0, self.angle
+
+
+def to_zone(width, height, box):
+    """Same convention as CollisionZone: relative to sprite center and size, y up"""
+    x, y, w, h, angle = box
+    # flipping the y axis turns an angle from the vertical towards +x into a counter
+    # clockwise one, which is the game convention: the angle is kept as is
+    return (x / width - 0.5, 0.5 - y / height, w / width, h / height, angle)
+
+
+def hand_tuned_zone(i):
+    """Built-in zone of frame i, converted as CollisionZone does"""
+    x, y, w, h, r = HAND_TUNED[i]
+    return (x / 200.0 - 0.5, 0.5 - y / 210.0, w / 200.0, h / 210.0, r)
+
+
+def size_error(bodies, trim_width, trim_height):
+    """Mean difference, in sprite size units, between fitted and hand-tuned boxes sizes"""
+    error = 0
+    for i, (width, height, body) in enumerate(bodies):
+        zone = to_zone(width, height, body.box(trim_width, trim_height))
+        ref = hand_tuned_zone(i)
+        error += abs(zone[2] - ref[2]) + abs(zone[3] - ref[3])
+    return error / len(bodies)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--input', default=os.path.join(ROOT, 'datas', 'textures', 'unprepared_assets', 'UI'))
+    parser.add_argument('--output', default=os.path.join(ROOT, 'assets', 'runner.collision'))
+    parser.add_argument('--threshold', type=int, default=128, help='min alpha of body pixels')
+    parser.add_argument('--trim-width', type=float, default=0.24, help='fraction of pixels left out across the body')
+    parser.add_argument('--trim-height', type=float, default=0.15, help='fraction of pixels left out along the body')
+    parser.add_argument('--dump', action='store_true', help='print zones')
+    parser.add_argument('--compare', action='store_true', help='print zones next to the hand-tuned ones')
+    parser.add_argument('--calibrate', action='store_true',
+        help='print the trim fractions giving the closest sizes to the hand-tuned zones, and exit')
+    args = parser.parse_args()
+
+    bodies = []
+    for frame in FRAMES:
+        width, height, rows = read_alpha(os.path.join(args.input, frame + '.png'))
+        bodies.append((width, height, Body(width, height, rows, args.threshold)))
+
+    if args.calibrate:
+        steps = [i / 100.0 for i in range(0, 45, 3)]
+        error, trim_width, trim_height = min((size_error(bodies, w, h), w, h) for w in steps for h in steps)
+        print('--trim-width %.2f --trim-height %.2f: mean size error %.3f' % (trim_width, trim_height, error))
+        return 0
+
+    zones = []
+    for i, (width, height, body) in enumerate(bodies):
+        zone = to_zone(width, height, body.box(args.trim_width, args.trim_height))
+        if args.dump:
+            print('%s: position=%.3f,%.3f size=%.3f,%.3f rotation=%.3f' % ((FRAMES[i],) + zone))
+        if args.compare:
+            ref = hand_tuned_zone(i)
+            print('%s: position=%.3f,%.3f (%+.3f,%+.3f) size=%.3f,%.3f (%+.3f,%+.3f) rotation=%.3f (%+.3f)' % (
+                FRAMES[i], zone[0], zone[1], zone[0] - ref[0], zone[1] - ref[1],
+                zone[2], zone[3], zone[2] - ref[2], zone[3] - ref[3], zone[4], zone[4] - ref[4]))
+        zones.append(zone)
+    if args.compare:
+        mean = [sum(abs(z[k] - hand_tuned_zone(i)[k]) for i, z in enumerate(zones)) / len(zones) for k in range(5)]
+        print('mean difference with hand-tuned zones: position=%.3f,%.3f size=%.3f,%.3f rotation=%.3f' % tuple(mean))
+
+    out = struct.pack('<4sHH', MAGIC, VERSION, len(FRAMES))
+    out += b''.join(struct.pack('<I', murmur_hash(frame)) for frame in FRAMES)
+    # as is, then mirrored for runners going right to left
+    out += b''.join(struct.pack('<5f', *z) for z in zones)
+    out += b''.join(struct.pack('<5f', -z[0], z[1], z[2], z[3], -z[4]) for z in zones)
+
+    with open(args.output, 'wb') as f:
+        f.write(out)
+    print('%s: %d frames, %d bytes' % (os.path.relpath(args.output), len(FRAMES), len(out)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())